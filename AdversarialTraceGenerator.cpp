@@ -0,0 +1,171 @@
+/**
+ * Adversarial Trace Generator
+ *
+ * Generates an LRU trace whose keys all collide under the unseeded polynomial
+ * hash (both the base-131 home slot and the base-257 step) for the table size
+ * that the harness uses for N. Optionally replays the trace under each hash
+ * policy to show the degradation with and without seeding.
+ *
+ * Construction: Horner's rule composes, h(AB) = h(A) * base^|B| + h(B), so if
+ * two equal-length blocks X and Y collide, every concatenation of k blocks
+ * drawn from {X, Y} collides too. A birthday search finds X and Y; 2^k words
+ * per side give 4^k two-word keys "wordA wordB" with identical hashes.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <random>
+#include <chrono>
+
+#include "HashFunctions.hpp"
+#include "HashTableDictionary.hpp"
+#include "LRUTrace.hpp"
+#include "TableSizes.hpp"
+
+// ============================================================================
+// Configuration
+// ============================================================================
+constexpr int DEFAULT_SEED = 23;
+constexpr std::size_t BLOCK_LENGTH = 8;
+const std::string PROFILE = "adversarial_profile";
+
+// ============================================================================
+// Collision Search
+// ============================================================================
+
+// Two distinct BLOCK_LENGTH-letter blocks with the same primary (mod M) and
+// secondary (mod M - 1) polynomial hash.
+std::pair<std::string, std::string> findCollidingBlocks(std::size_t M, std::mt19937_64& rng) {
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::unordered_map<std::uint64_t, std::string> seen;
+
+    while (true) {
+        std::string block(BLOCK_LENGTH, 'a');
+        for (auto& c : block)
+            c = static_cast<char>(letter(rng));
+
+        const std::uint64_t fingerprint = polynomialModHash(block, 131, M) * (M - 1) +
+                                          polynomialModHash(block, 257, M - 1);
+        auto [it, inserted] = seen.emplace(fingerprint, block);
+        if (!inserted && it->second != block)
+            return {it->second, block};
+    }
+}
+
+std::vector<std::string> buildCollidingKeys(std::size_t N, std::size_t M, std::mt19937_64& rng) {
+    const auto [x, y] = findCollidingBlocks(M, rng);
+    std::cout << "Colliding blocks for M = " << M << ": \"" << x << "\" and \"" << y << "\"" << std::endl;
+
+    // 4^k >= 4N keys.
+    std::size_t k = 1;
+    while ((std::size_t{1} << (2 * k)) < 4 * N)
+        k++;
+
+    std::vector<std::string> words(std::size_t{1} << k);
+    for (std::size_t w = 0; w < words.size(); w++)
+        for (std::size_t b = 0; b < k; b++)
+            words[w] += ((w >> b) & 1) ? y : x;
+
+    std::vector<std::string> keys;
+    keys.reserve(4 * N);
+    for (std::size_t i = 0; keys.size() < 4 * N; i++)
+        keys.push_back(words[i >> k] + " " + words[i & (words.size() - 1)]);
+    return keys;
+}
+
+// ============================================================================
+// Replay Comparison
+// ============================================================================
+
+void compareHashPolicies(const std::vector<std::string>& accessStream, std::size_t N, std::size_t M) {
+    const std::vector<std::pair<std::string, HashTableDictionary::HASH_POLICY>> policies = {
+        {"polynomial", HashTableDictionary::POLYNOMIAL},
+        {"siphash", HashTableDictionary::SIPHASH},
+        {"fast", HashTableDictionary::FAST},
+    };
+
+    std::vector<std::string> rows;
+    for (const auto& [name, policy] : policies) {
+        for (auto probeType : {HashTableDictionary::SINGLE, HashTableDictionary::DOUBLE}) {
+            HashTableDictionary table(M, probeType, true, 0.95, policy);
+
+            const auto t0 = std::chrono::steady_clock::now();
+            forEachLRUOperation(accessStream, N, [&table](char op, const std::string& key) {
+                if (op == 'I')
+                    table.insert(key);
+                else if (op == 'L')
+                    table.member(key);
+                else
+                    table.remove(key);
+            });
+            const auto t1 = std::chrono::steady_clock::now();
+
+            rows.push_back(name + "," +
+                           std::to_string(std::chrono::duration<double, std::milli>(t1 - t0).count()) + "," +
+                           table.csvStats());
+        }
+    }
+
+    std::cout << "\nhash_policy,elapsed_ms," << HashTableDictionary::csvStatsHeader() << std::endl;
+    for (const auto& row : rows)
+        std::cout << row << std::endl;
+}
+
+// ============================================================================
+// Main Program
+// ============================================================================
+
+void printUsage(const char* progName) {
+    std::cerr << "Usage: " << progName << " <N> [seed] [output_file] [--compare]" << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "  --compare  replay the trace under each hash policy and print csv stats." << std::endl;
+    std::cerr << "             The unseeded runs are quadratic; keep N small (<= 8192)." << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args;
+    bool compare = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--compare")
+            compare = true;
+        else
+            args.emplace_back(argv[i]);
+    }
+    if (args.empty() || args.size() > 3) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    const std::size_t N = std::stoull(args[0]);
+    if (N == 0) {
+        std::cerr << "N must be positive" << std::endl;
+        return 1;
+    }
+    const std::size_t M = tableSizeForN(N);
+    const int seed = args.size() >= 2 ? std::stoi(args[1]) : DEFAULT_SEED;
+    const std::string outputFile = args.size() >= 3 ? args[2] :
+        PROFILE + "_N_" + std::to_string(N) + "_S_" + std::to_string(seed) + ".trace";
+
+    std::mt19937_64 rng(seed);
+    const auto keys = buildCollidingKeys(N, M, rng);
+
+    std::cout << "Building access stream for N = " << N << "..." << std::endl;
+    const auto accessStream = buildAccessStream(keys, N, seed);
+
+    std::ofstream outFile(outputFile);
+    if (!outFile.is_open()) {
+        std::cerr << "Cannot create output file: " << outputFile << std::endl;
+        return 1;
+    }
+    generateLRUTrace(accessStream, N, outFile, PROFILE, seed);
+    outFile.close();
+    std::cout << "Trace written to: " << outputFile << std::endl;
+
+    if (compare)
+        compareHashPolicies(accessStream, N, M);
+
+    return 0;
+}
@@ -0,0 +1,141 @@
+/**
+ * BinaryTrace.cpp - The .btrace binary trace format.
+ */
+
+#include "BinaryTrace.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+namespace {
+template<typename T>
+void appendRaw(std::string& buffer, T value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void padTo8(std::string& buffer) {
+    buffer.append((8 - buffer.size() % 8) % 8, '\0');
+}
+
+constexpr std::size_t paddedTo8(std::size_t n) {
+    return (n + 7) / 8 * 8;
+}
+
+// Fixed part of the header, before the profile bytes.
+constexpr std::size_t FIXED_HEADER_BYTES = 4 + 4 + 6 * 8 + 4;
+}
+
+BinaryTraceWriter::BinaryTraceWriter(std::string profile_, std::uint64_t N_, std::int64_t seed_):
+    profile{std::move(profile_)}, N{N_}, seed{seed_} {}
+
+void BinaryTraceWriter::add(char op, std::string_view key) {
+    auto [it, inserted] = keyIds.emplace(std::string(key), static_cast<std::uint32_t>(keyOffsets.size() - 1));
+    if (inserted) {
+        keyBytes.append(key);
+        keyOffsets.push_back(static_cast<std::uint32_t>(keyBytes.size()));
+    }
+
+    const std::uint64_t opcode = op == 'E' ? 1 : op == 'L' ? 2 : 0;
+    std::uint64_t v = (static_cast<std::uint64_t>(it->second) << 2) | opcode;
+    while (v >= 0x80) {
+        opStream.push_back(static_cast<unsigned char>(v | 0x80));
+        v >>= 7;
+    }
+    opStream.push_back(static_cast<unsigned char>(v));
+    opCount++;
+}
+
+bool BinaryTraceWriter::write(const std::string& path) const {
+    if (keyBytes.size() > std::numeric_limits<std::uint32_t>::max()) {
+        std::cerr << "Key dictionary exceeds 4 GB; cannot write " << path << std::endl;
+        return false;
+    }
+
+    std::string image;
+    image.reserve(FIXED_HEADER_BYTES + profile.size() + keyOffsets.size() * 4 + keyBytes.size() +
+                  opStream.size() + 3 * 8);
+    image.append("BTRC", 4);
+    appendRaw<std::uint32_t>(image, BTRACE_VERSION);
+    appendRaw<std::uint64_t>(image, N);
+    appendRaw<std::int64_t>(image, seed);
+    appendRaw<std::uint64_t>(image, keyOffsets.size() - 1);
+    appendRaw<std::uint64_t>(image, keyBytes.size());
+    appendRaw<std::uint64_t>(image, opCount);
+    appendRaw<std::uint64_t>(image, opStream.size());
+    appendRaw<std::uint32_t>(image, static_cast<std::uint32_t>(profile.size()));
+    image.append(profile);
+    padTo8(image);
+    image.append(reinterpret_cast<const char*>(keyOffsets.data()), keyOffsets.size() * 4);
+    padTo8(image);
+    image.append(keyBytes);
+    padTo8(image);
+    image.append(reinterpret_cast<const char*>(opStream.data()), opStream.size());
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "Cannot create output file: " << path << std::endl;
+        return false;
+    }
+    out.write(image.data(), static_cast<std::streamsize>(image.size()));
+    return static_cast<bool>(out);
+}
+
+bool openBinaryTrace(const char* data, std::size_t size, BinaryTraceView& view, std::string& error) {
+    if (size < FIXED_HEADER_BYTES || std::memcmp(data, "BTRC", 4) != 0) {
+        error = "not a .btrace file";
+        return false;
+    }
+
+    std::uint32_t version, profileLength;
+    std::uint64_t keyByteCount;
+    std::memcpy(&version, data + 4, 4);
+    std::memcpy(&view.N, data + 8, 8);
+    std::memcpy(&view.seed, data + 16, 8);
+    std::memcpy(&view.keyCount, data + 24, 8);
+    std::memcpy(&keyByteCount, data + 32, 8);
+    std::memcpy(&view.opCount, data + 40, 8);
+    std::memcpy(&view.opStreamBytes, data + 48, 8);
+    std::memcpy(&profileLength, data + 56, 4);
+
+    if (version != 1 && version != BTRACE_VERSION) {
+        error = "unsupported .btrace version " + std::to_string(version);
+        return false;
+    }
+    view.opcodeBits = version == 1 ? 1 : 2;
+
+    // Section sizes come from the file, so check each against what remains.
+    std::size_t offset = FIXED_HEADER_BYTES;
+    auto take = [&](std::uint64_t bytes, std::size_t& start) {
+        if (bytes > size - offset)
+            return false;
+        start = offset;
+        offset = std::min<std::size_t>(size, paddedTo8(offset + bytes));
+        return true;
+    };
+    std::size_t profileStart, offsetsStart, keysStart, opsStart;
+    if (view.keyCount >= std::numeric_limits<std::uint32_t>::max() ||
+        !take(profileLength, profileStart) || !take((view.keyCount + 1) * 4, offsetsStart) ||
+        !take(keyByteCount, keysStart) || !take(view.opStreamBytes, opsStart)) {
+        error = "truncated .btrace file";
+        return false;
+    }
+
+    view.profile.assign(data + profileStart, profileLength);
+    view.keyOffsets = reinterpret_cast<const std::uint32_t*>(data + offsetsStart);
+    view.keyBytes = data + keysStart;
+    view.opStream = reinterpret_cast<const unsigned char*>(data + opsStart);
+
+    if (view.keyOffsets[0] != 0 || view.keyOffsets[view.keyCount] != keyByteCount) {
+        error = "corrupt .btrace key dictionary";
+        return false;
+    }
+    for (std::uint64_t i = 0; i < view.keyCount; i++) {
+        if (view.keyOffsets[i] > view.keyOffsets[i + 1]) {
+            error = "corrupt .btrace key dictionary";
+            return false;
+        }
+    }
+    return true;
+}
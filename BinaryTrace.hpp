@@ -0,0 +1,107 @@
+/**
+ * BinaryTrace.hpp - The .btrace binary trace format.
+ *
+ * A .btrace stores every distinct key once and the operations as key ids, so
+ * a trace loads with one mmap and a varint decode instead of text parsing.
+ * Layout (little-endian, sections 8-byte aligned by zero padding):
+ *
+ *   header      "BTRC"  u32 version (2)
+ *               u64 N   i64 seed   u64 key_count   u64 key_bytes
+ *               u64 op_count   u64 op_stream_bytes
+ *               u32 profile_length, profile bytes, pad
+ *   dictionary  u32 key_offsets[key_count + 1], pad   (key i = bytes [off[i], off[i+1]))
+ *               key bytes, pad
+ *   op stream   op_count LEB128 varints of (key_id << 2) | opcode,
+ *               opcode 0 = insert, 1 = erase, 2 = lookup
+ *
+ * Version 1 files, written before lookups existed, use a single opcode bit
+ * ((key_id << 1) | opcode); they are still read.
+ */
+
+#ifndef HASHTABLESOPENADDRESSING_BINARYTRACE_HPP
+#define HASHTABLESOPENADDRESSING_BINARYTRACE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+constexpr std::uint32_t BTRACE_VERSION = 2;
+
+// Interns keys and collects the op stream, then writes the file in one write.
+class BinaryTraceWriter {
+public:
+    BinaryTraceWriter(std::string profile, std::uint64_t N, std::int64_t seed);
+
+    // op is 'I', 'E' or 'L', as emitted by forEachLRUOperation.
+    void add(char op, std::string_view key);
+    bool write(const std::string& path) const;
+
+    [[nodiscard]] std::uint64_t numOperations() const { return opCount; }
+    [[nodiscard]] std::size_t numKeys() const { return keyOffsets.size() - 1; }
+
+private:
+    std::string profile;
+    std::uint64_t N;
+    std::int64_t seed;
+
+    std::unordered_map<std::string, std::uint32_t> keyIds;
+    std::vector<std::uint32_t> keyOffsets{0};
+    std::string keyBytes;
+    std::vector<unsigned char> opStream;
+    std::uint64_t opCount = 0;
+};
+
+// A validated .btrace image. Pointers refer into the caller's buffer/mapping.
+struct BinaryTraceView {
+    std::string profile;
+    std::uint64_t N = 0;
+    std::int64_t seed = 0;
+    std::uint64_t keyCount = 0;
+    std::uint64_t opCount = 0;
+    const std::uint32_t* keyOffsets = nullptr;
+    const char* keyBytes = nullptr;
+    const unsigned char* opStream = nullptr;
+    std::uint64_t opStreamBytes = 0;
+    unsigned opcodeBits = 2;  // 1 in version 1 files
+
+    [[nodiscard]] std::string_view key(std::uint64_t id) const {
+        return {keyBytes + keyOffsets[id], keyOffsets[id + 1] - keyOffsets[id]};
+    }
+};
+
+// Checks the header and section bounds of `size` bytes at `data` (which must be
+// 8-byte aligned, as an mmap is). On failure returns false and sets `error`.
+bool openBinaryTrace(const char* data, std::size_t size, BinaryTraceView& view, std::string& error);
+
+// Calls emit(op, keyId) for each operation in order, op being 'I', 'E' or 'L'.
+// Returns false if the stream is truncated, has an unknown opcode or names a
+// key id out of range.
+template<typename Emit>
+bool decodeBinaryTraceOps(const BinaryTraceView& view, Emit&& emit) {
+    const unsigned char* p = view.opStream;
+    const unsigned char* end = p + view.opStreamBytes;
+    for (std::uint64_t i = 0; i < view.opCount; i++) {
+        std::uint64_t v = 0;
+        int shift = 0;
+        while (true) {
+            if (p == end || shift > 63)
+                return false;
+            const unsigned char byte = *p++;
+            v |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+                break;
+            shift += 7;
+        }
+        const std::uint64_t opcode = v & ((1u << view.opcodeBits) - 1);
+        const std::uint64_t keyId = v >> view.opcodeBits;
+        if (keyId >= view.keyCount || opcode > 2)
+            return false;
+        emit("IEL"[opcode], keyId);
+    }
+    return true;
+}
+
+#endif //HASHTABLESOPENADDRESSING_BINARYTRACE_HPP
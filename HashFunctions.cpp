@@ -0,0 +1,226 @@
+//
+// HashFunctions.cpp
+//
+
+#include "HashFunctions.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HASH_FUNCTIONS_HAVE_AVX2_PATH 1
+#endif
+
+std::size_t polynomialModHash(std::string_view v, std::size_t base, std::size_t modulus) {
+    std::size_t idx = 0;
+    for (unsigned char c : v) {
+        idx = (idx * base + c) % modulus;
+    }
+    return idx;
+}
+
+std::uint64_t polynomialHash64(std::string_view v, std::uint64_t base) {
+    std::uint64_t h = 0;
+    for (unsigned char c : v) {
+        h = h * base + c;
+    }
+    return h;
+}
+
+namespace {
+void polynomialModHashBatchScalar(const std::string_view* keys, std::size_t count,
+                                  std::size_t modulus, std::size_t stepModulus,
+                                  std::size_t* home, std::size_t* step, std::uint32_t* fingerprint) {
+    for (std::size_t i = 0; i < count; i++) {
+        home[i] = polynomialModHash(keys[i], 131, modulus);
+        step[i] = polynomialModHash(keys[i], 257, stepModulus);
+        fingerprint[i] = static_cast<std::uint32_t>(polynomialHash64(keys[i], 131));
+    }
+}
+
+#ifdef HASH_FUNCTIONS_HAVE_AVX2_PATH
+// x mod m per 32-bit lane for 0 <= x < 2^31. The float quotient estimate is
+// off by at most one either way, which the two corrections absorb.
+__attribute__((target("avx2")))
+inline __m256i modLanes(__m256i x, __m256i m, __m256 inverseM) {
+    const __m256i q = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(x), inverseM));
+    __m256i r = _mm256_sub_epi32(x, _mm256_mullo_epi32(q, m));
+    r = _mm256_add_epi32(r, _mm256_and_si256(_mm256_cmpgt_epi32(_mm256_setzero_si256(), r), m));
+    r = _mm256_sub_epi32(r, _mm256_andnot_si256(_mm256_cmpgt_epi32(m, r), m));
+    return r;
+}
+
+__attribute__((target("avx2")))
+void polynomialModHashBatchAvx2(const std::string_view* keys, std::size_t count,
+                                std::size_t modulus, std::size_t stepModulus,
+                                std::size_t* home, std::size_t* step, std::uint32_t* fingerprint) {
+    const __m256i homeM = _mm256_set1_epi32(static_cast<int>(modulus));
+    const __m256i stepM = _mm256_set1_epi32(static_cast<int>(stepModulus));
+    const __m256 homeInverse = _mm256_set1_ps(1.0f / static_cast<float>(modulus));
+    const __m256 stepInverse = _mm256_set1_ps(1.0f / static_cast<float>(stepModulus));
+    const __m256i base131 = _mm256_set1_epi32(131);
+    const __m256i base257 = _mm256_set1_epi32(257);
+    const __m256i byteMask = _mm256_set1_epi32(0xff);
+
+    std::size_t first = 0;
+    for (; first + 8 <= count; first += 8) {
+        alignas(32) std::int32_t lengths[8];
+        std::size_t maxLength = 0;
+        for (int lane = 0; lane < 8; lane++) {
+            lengths[lane] = static_cast<std::int32_t>(keys[first + lane].size());
+            maxLength = std::max<std::size_t>(maxLength, keys[first + lane].size());
+        }
+        const __m256i length = _mm256_load_si256(reinterpret_cast<const __m256i*>(lengths));
+
+        __m256i h = _mm256_setzero_si256(), s = _mm256_setzero_si256(), f = _mm256_setzero_si256();
+        for (std::size_t pos = 0; pos < maxLength; pos += 4) {
+            // Four bytes per lane: gathered straight from the key when the lane
+            // has a full word left, assembled byte by byte for the tail.
+            const __m256i position = _mm256_set1_epi32(static_cast<int>(pos));
+            const __m256i fullWord = _mm256_cmpgt_epi32(length, _mm256_add_epi32(position, _mm256_set1_epi32(3)));
+            const __m256i addrLow = _mm256_set_epi64x(
+                reinterpret_cast<long long>(keys[first + 3].data() + pos), reinterpret_cast<long long>(keys[first + 2].data() + pos),
+                reinterpret_cast<long long>(keys[first + 1].data() + pos), reinterpret_cast<long long>(keys[first + 0].data() + pos));
+            const __m256i addrHigh = _mm256_set_epi64x(
+                reinterpret_cast<long long>(keys[first + 7].data() + pos), reinterpret_cast<long long>(keys[first + 6].data() + pos),
+                reinterpret_cast<long long>(keys[first + 5].data() + pos), reinterpret_cast<long long>(keys[first + 4].data() + pos));
+            const __m128i low = _mm256_mask_i64gather_epi32(_mm_setzero_si128(), nullptr, addrLow,
+                                                            _mm256_castsi256_si128(fullWord), 1);
+            const __m128i high = _mm256_mask_i64gather_epi32(_mm_setzero_si128(), nullptr, addrHigh,
+                                                             _mm256_extracti128_si256(fullWord, 1), 1);
+            __m256i words = _mm256_set_m128i(high, low);
+
+            if (_mm256_movemask_ps(_mm256_castsi256_ps(fullWord)) != 0xff) {
+                alignas(32) std::uint32_t tails[8] = {};
+                for (int lane = 0; lane < 8; lane++) {
+                    const std::size_t remaining = pos < keys[first + lane].size() ? keys[first + lane].size() - pos : 0;
+                    if (remaining > 0 && remaining < 4)
+                        for (std::size_t b = 0; b < remaining; b++)
+                            tails[lane] |= static_cast<std::uint32_t>(static_cast<unsigned char>(keys[first + lane][pos + b])) << (8 * b);
+                }
+                words = _mm256_or_si256(words, _mm256_load_si256(reinterpret_cast<const __m256i*>(tails)));
+            }
+
+            for (int b = 0; b < 4; b++) {
+                const __m256i active = _mm256_cmpgt_epi32(length, _mm256_add_epi32(position, _mm256_set1_epi32(b)));
+                const __m256i c = _mm256_and_si256(_mm256_srli_epi32(words, 8 * b), byteMask);
+                const __m256i nextH = modLanes(_mm256_add_epi32(_mm256_mullo_epi32(h, base131), c), homeM, homeInverse);
+                const __m256i nextS = modLanes(_mm256_add_epi32(_mm256_mullo_epi32(s, base257), c), stepM, stepInverse);
+                const __m256i nextF = _mm256_add_epi32(_mm256_mullo_epi32(f, base131), c);
+                h = _mm256_blendv_epi8(h, nextH, active);
+                s = _mm256_blendv_epi8(s, nextS, active);
+                f = _mm256_blendv_epi8(f, nextF, active);
+            }
+        }
+
+        alignas(32) std::uint32_t hs[8], ss[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(hs), h);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(ss), s);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(fingerprint + first), f);
+        for (int lane = 0; lane < 8; lane++) {
+            home[first + lane] = hs[lane];
+            step[first + lane] = ss[lane];
+        }
+    }
+
+    polynomialModHashBatchScalar(keys + first, count - first, modulus, stepModulus,
+                                 home + first, step + first, fingerprint + first);
+}
+#endif
+}
+
+void polynomialModHashBatch(const std::string_view* keys, std::size_t count,
+                            std::size_t modulus, std::size_t stepModulus,
+                            std::size_t* home, std::size_t* step, std::uint32_t* fingerprint) {
+#ifdef HASH_FUNCTIONS_HAVE_AVX2_PATH
+    // Lanes hold idx * 257 + 255 in a signed 32-bit int, with idx < modulus.
+    constexpr std::size_t laneLimit = (INT32_MAX - 255) / 257;
+    static const bool haveAvx2 = __builtin_cpu_supports("avx2");
+    if (haveAvx2 && modulus > 1 && modulus < laneLimit && stepModulus > 1 && stepModulus < laneLimit) {
+        polynomialModHashBatchAvx2(keys, count, modulus, stepModulus, home, step, fingerprint);
+        return;
+    }
+#endif
+    polynomialModHashBatchScalar(keys, count, modulus, stepModulus, home, step, fingerprint);
+}
+
+std::uint64_t fnv1aHash64(std::string_view v) {
+    std::uint64_t h = 0xcbf29ce484222325ULL;
+    for (unsigned char c : v) {
+        h ^= c;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+namespace {
+inline std::uint64_t rotl(std::uint64_t x, int b) {
+    return (x << b) | (x >> (64 - b));
+}
+
+inline void sipRound(std::uint64_t& v0, std::uint64_t& v1, std::uint64_t& v2, std::uint64_t& v3) {
+    v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32);
+    v2 += v3; v3 = rotl(v3, 16); v3 ^= v2;
+    v0 += v3; v3 = rotl(v3, 21); v3 ^= v0;
+    v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32);
+}
+
+// Little-endian load of up to 8 bytes.
+inline std::uint64_t load64(const unsigned char* p, std::size_t n) {
+    std::uint64_t w = 0;
+    for (std::size_t i = 0; i < n; i++)
+        w |= static_cast<std::uint64_t>(p[i]) << (8 * i);
+    return w;
+}
+
+// 64x64 -> 128-bit multiply folded back to 64 bits.
+inline std::uint64_t foldedMultiply(std::uint64_t a, std::uint64_t b) {
+    const unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+    return static_cast<std::uint64_t>(r) ^ static_cast<std::uint64_t>(r >> 64);
+}
+}
+
+std::uint64_t sipHash24(std::string_view v, std::uint64_t k0, std::uint64_t k1) {
+    std::uint64_t v0 = 0x736f6d6570736575ULL ^ k0;
+    std::uint64_t v1 = 0x646f72616e646f6dULL ^ k1;
+    std::uint64_t v2 = 0x6c7967656e657261ULL ^ k0;
+    std::uint64_t v3 = 0x7465646279746573ULL ^ k1;
+
+    const auto* p = reinterpret_cast<const unsigned char*>(v.data());
+    const std::size_t n = v.size();
+    const std::size_t full = n - n % 8;
+    for (std::size_t i = 0; i < full; i += 8) {
+        const std::uint64_t m = load64(p + i, 8);
+        v3 ^= m;
+        sipRound(v0, v1, v2, v3);
+        sipRound(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+    const std::uint64_t last = load64(p + full, n % 8) | (static_cast<std::uint64_t>(n & 0xff) << 56);
+    v3 ^= last;
+    sipRound(v0, v1, v2, v3);
+    sipRound(v0, v1, v2, v3);
+    v0 ^= last;
+
+    v2 ^= 0xff;
+    for (int i = 0; i < 4; i++)
+        sipRound(v0, v1, v2, v3);
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+std::uint64_t fastHash64(std::string_view v, std::uint64_t seed) {
+    const auto* p = reinterpret_cast<const unsigned char*>(v.data());
+    std::size_t n = v.size();
+    // Folding the length in up front keeps zero-padded tails unambiguous.
+    std::uint64_t h = seed ^ (n * 0x9e3779b97f4a7c15ULL);
+    while (n >= 8) {
+        std::uint64_t w;
+        std::memcpy(&w, p, 8);
+        h = foldedMultiply(h ^ w, 0xa0761d6478bd642fULL);
+        p += 8;
+        n -= 8;
+    }
+    h = foldedMultiply(h ^ load64(p, n), 0xe7037ed1a0b428dbULL);
+    return foldedMultiply(h ^ 0x589965cc75374cc3ULL, 0x8ebc6af09c88c6e3ULL ^ seed);
+}
@@ -0,0 +1,43 @@
+//
+// HashFunctions.hpp - String hash functions shared by HashTableDictionary and
+// the analysis tools.
+//
+
+#ifndef HASHTABLESOPENADDRESSING_HASHFUNCTIONS_HPP
+#define HASHTABLESOPENADDRESSING_HASHFUNCTIONS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Horner's rule reduced modulo `modulus` after every character. This is the
+// table's original hash: base 131 for the home slot, base 257 for the step.
+std::size_t polynomialModHash(std::string_view v, std::size_t base, std::size_t modulus);
+
+// The same polynomial evaluated in wrapping 64-bit arithmetic; the caller
+// reduces once at the end instead of once per character.
+std::uint64_t polynomialHash64(std::string_view v, std::uint64_t base);
+
+// Batched form of the table's two polynomial hashes over `count` keys:
+// home[i] = polynomialModHash(keys[i], 131, modulus),
+// step[i] = polynomialModHash(keys[i], 257, stepModulus),
+// fingerprint[i] = low 32 bits of polynomialHash64(keys[i], 131).
+// Uses AVX2 (8 keys per pass, finished lanes masked off) when the CPU has it
+// and both moduli are below (2^31 - 256) / 257, about 8.36e6; otherwise falls
+// back to the scalar loops.
+void polynomialModHashBatch(const std::string_view* keys, std::size_t count,
+                            std::size_t modulus, std::size_t stepModulus,
+                            std::size_t* home, std::size_t* step, std::uint32_t* fingerprint);
+
+// 64-bit FNV-1a.
+std::uint64_t fnv1aHash64(std::string_view v);
+
+// SipHash-2-4 under the 128-bit key (k0, k1). Keyed PRF: without the key an
+// attacker cannot construct colliding inputs, so use it for untrusted keys.
+std::uint64_t sipHash24(std::string_view v, std::uint64_t k0, std::uint64_t k1);
+
+// Seeded multiply-mix hash consuming 8 bytes per round. Much cheaper than
+// SipHash but offers no collision resistance; for trusted keys only.
+std::uint64_t fastHash64(std::string_view v, std::uint64_t seed);
+
+#endif //HASHTABLESOPENADDRESSING_HASHFUNCTIONS_HPP
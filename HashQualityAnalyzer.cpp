@@ -0,0 +1,270 @@
+/**
+ * Hash Quality Analyzer
+ *
+ * Runs every candidate hash over the shipped corpora (and the two-word keys of
+ * any trace files) and reports, for each table size M in N_to_M_mapping:
+ *   - chi-square of the bucket loads (and chi-square / (buckets - 1), ~1 when uniform)
+ *   - the largest bucket
+ *   - avalanche bias: over the output bits, the mean distance of P(output bit
+ *     flips) when a single input bit is flipped from the flip probability of
+ *     two independent uniform slots, scaled so 0 = ideal and 1 = the bit never
+ *     (or always) flips. For M not a power of two the high bits are rarely set,
+ *     so their ideal flip probability is below 1/2.
+ *   - hashing throughput in GB/s of key bytes
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <filesystem>
+
+#include "HashFunctions.hpp"
+#include "TableSizes.hpp"
+
+// ============================================================================
+// Configuration
+// ============================================================================
+const std::vector<std::string> DEFAULT_CORPORA = {
+    "../all_uniq_tokens_imdb_and_newsgroups.txt",
+    "../6770_uniq_words.txt"
+};
+const std::string DEFAULT_TRACE_DIR = "../traceFiles";
+const std::string CSV_PATH = "../csvs/hash_quality.csv";
+
+constexpr std::size_t AVALANCHE_SAMPLE = 2000;
+constexpr double MIN_TIMING_SECONDS = 0.05;
+
+// Fixed keys for the seeded hashes so runs are comparable.
+constexpr std::uint64_t ANALYSIS_KEY0 = 0x0706050403020100ULL;
+constexpr std::uint64_t ANALYSIS_KEY1 = 0x0f0e0d0c0b0a0908ULL;
+
+// Calls visit(name, slot, buckets) once per hash under test, where slot(key, M)
+// maps a key to one of buckets(M) values for table size M. Each hash is its
+// own lambda type, so the measurement loops are instantiated per hash and the
+// hash inlines into them.
+template <typename Visit>
+void forEachHashUnderTest(Visit visit) {
+    auto tableSize = [](std::size_t M) { return M; };
+    visit("primary_poly131_mod",
+          [](std::string_view k, std::size_t M) { return polynomialModHash(k, 131, M); }, tableSize);
+    visit("secondary_poly257_mod",
+          [](std::string_view k, std::size_t M) { return polynomialModHash(k, 257, M - 1); },
+          [](std::size_t M) { return M - 1; });
+    visit("poly131_64bit",
+          [](std::string_view k, std::size_t M) { return static_cast<std::size_t>(polynomialHash64(k, 131) % M); },
+          tableSize);
+    visit("fnv1a_64",
+          [](std::string_view k, std::size_t M) { return static_cast<std::size_t>(fnv1aHash64(k) % M); },
+          tableSize);
+    visit("siphash24",
+          [](std::string_view k, std::size_t M) {
+              return static_cast<std::size_t>(sipHash24(k, ANALYSIS_KEY0, ANALYSIS_KEY1) % M);
+          }, tableSize);
+    visit("fast_seeded",
+          [](std::string_view k, std::size_t M) { return static_cast<std::size_t>(fastHash64(k, ANALYSIS_KEY0) % M); },
+          tableSize);
+}
+
+// ============================================================================
+// Key Loading
+// ============================================================================
+
+// Corpus files hold one key per line. Trace files contribute the distinct
+// two-word keys of their I/E lines.
+bool loadKeys(const std::string& path, std::vector<std::string>& keys) {
+    keys.clear();
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        std::cerr << "Cannot open key file: " << path << std::endl;
+        return false;
+    }
+
+    const bool isTrace = path.size() >= 6 && path.compare(path.size() - 6, 6, ".trace") == 0;
+    std::string line;
+    if (!isTrace) {
+        while (std::getline(in, line)) {
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (!line.empty())
+                keys.push_back(line);
+        }
+        return true;
+    }
+
+    std::unordered_set<std::string> seen;
+    std::getline(in, line);  // header
+    while (std::getline(in, line)) {
+        std::istringstream iss(line);
+        std::string op, w1, w2;
+        if (!(iss >> op >> w1 >> w2) || op[0] == '#')
+            continue;
+        std::string key = w1 + " " + w2;
+        if (seen.insert(key).second)
+            keys.push_back(key);
+    }
+    return true;
+}
+
+// ============================================================================
+// Metrics
+// ============================================================================
+
+struct HashQuality {
+    double chiSquare = 0.0;
+    double chiSquarePerDof = 0.0;
+    std::size_t largestBucket = 0;
+    double avalancheBias = 0.0;
+    double gbPerSec = 0.0;
+};
+
+// Written once per timing run so the timed loop is not optimized away.
+volatile std::size_t timingSink;
+
+// Probability that bit `b` differs between two independent values drawn
+// uniformly from [0, buckets).
+double idealFlipProbability(std::size_t buckets, int b) {
+    const std::size_t period = std::size_t{1} << (b + 1), half = std::size_t{1} << b;
+    const std::size_t set = buckets / period * half + (buckets % period > half ? buckets % period - half : 0);
+    const double p = static_cast<double>(set) / static_cast<double>(buckets);
+    return 2.0 * p * (1.0 - p);
+}
+
+template <typename Slot>
+HashQuality measure(Slot slot, std::size_t buckets, const std::vector<std::string>& keys,
+                    std::size_t keyBytes, std::size_t M) {
+    HashQuality q;
+
+    std::vector<std::size_t> loads(buckets, 0);
+    for (const auto& key : keys)
+        loads[slot(key, M)]++;
+    const double expected = static_cast<double>(keys.size()) / static_cast<double>(buckets);
+    for (auto load : loads) {
+        const double diff = static_cast<double>(load) - expected;
+        q.chiSquare += diff * diff / expected;
+    }
+    q.chiSquarePerDof = q.chiSquare / static_cast<double>(buckets - 1);
+    q.largestBucket = *std::max_element(loads.begin(), loads.end());
+
+    // Output bits are the bits needed to name a bucket.
+    int outBits = 0;
+    while ((std::size_t{1} << outBits) < buckets)
+        outBits++;
+    std::vector<std::size_t> flips(outBits, 0);
+    std::size_t trials = 0;
+    const std::size_t step = std::max<std::size_t>(keys.size() / AVALANCHE_SAMPLE, 1);
+    for (std::size_t k = 0; k < keys.size(); k += step) {
+        std::string key = keys[k];
+        const std::size_t base = slot(key, M);
+        for (std::size_t bit = 0; bit < key.size() * 8; bit++) {
+            key[bit / 8] = static_cast<char>(key[bit / 8] ^ (1 << (bit % 8)));
+            const std::size_t changed = base ^ slot(key, M);
+            key[bit / 8] = static_cast<char>(key[bit / 8] ^ (1 << (bit % 8)));
+            for (int b = 0; b < outBits; b++)
+                flips[b] += (changed >> b) & 1;
+            trials++;
+        }
+    }
+    for (int b = 0; b < outBits; b++) {
+        const double ideal = idealFlipProbability(buckets, b);
+        const double observed = static_cast<double>(flips[b]) / static_cast<double>(trials);
+        q.avalancheBias += observed < ideal ? (ideal - observed) / ideal : (observed - ideal) / (1.0 - ideal);
+    }
+    q.avalancheBias /= outBits;
+
+    using clock = std::chrono::steady_clock;
+    std::size_t sink = 0, passes = 0;
+    const auto t0 = clock::now();
+    double seconds = 0.0;
+    do {
+        for (const auto& key : keys)
+            sink += slot(key, M);
+        passes++;
+        seconds = std::chrono::duration<double>(clock::now() - t0).count();
+    } while (seconds < MIN_TIMING_SECONDS);
+    q.gbPerSec = static_cast<double>(keyBytes * passes) / seconds / 1e9;
+    timingSink = sink;
+
+    return q;
+}
+
+// ============================================================================
+// Main Program
+// ============================================================================
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; i++)
+        inputs.emplace_back(argv[i]);
+
+    if (inputs.empty()) {
+        inputs = DEFAULT_CORPORA;
+        namespace fs = std::filesystem;
+        std::error_code ec;
+        if (fs::is_directory(DEFAULT_TRACE_DIR, ec)) {
+            std::vector<std::string> traces;
+            for (const auto& entry : fs::directory_iterator(DEFAULT_TRACE_DIR, ec))
+                if (entry.path().extension() == ".trace")
+                    traces.push_back(entry.path().string());
+            std::sort(traces.begin(), traces.end());
+            inputs.insert(inputs.end(), traces.begin(), traces.end());
+        }
+    }
+
+    const std::string header = "corpus,keys,hash,N,table_size,buckets,chi_square,chi_square_per_dof,"
+                               "largest_bucket,avalanche_bias,gb_per_sec";
+    std::vector<std::string> rows;
+
+    for (const auto& input : inputs) {
+        std::vector<std::string> keys;
+        if (!loadKeys(input, keys) || keys.empty())
+            continue;
+        std::size_t keyBytes = 0;
+        for (const auto& key : keys)
+            keyBytes += key.size();
+
+        const auto pos = input.find_last_of("/\\");
+        const std::string corpusName = pos == std::string::npos ? input : input.substr(pos + 1);
+        std::cout << "\n" << corpusName << ": " << keys.size() << " keys, " << keyBytes << " bytes\n";
+
+        forEachHashUnderTest([&](const char* name, auto slot, auto buckets) {
+            for (const auto& [N, M] : N_to_M_mapping) {
+                const HashQuality q = measure(slot, buckets(M), keys, keyBytes, M);
+                std::ostringstream row;
+                row << corpusName << ',' << keys.size() << ',' << name << ',' << N << ',' << M << ','
+                    << buckets(M) << ',' << q.chiSquare << ',' << q.chiSquarePerDof << ','
+                    << q.largestBucket << ',' << q.avalancheBias << ',' << q.gbPerSec;
+                rows.push_back(row.str());
+                std::cout << "  " << name << " M=" << M
+                          << "  chi2/dof=" << q.chiSquarePerDof
+                          << "  max_bucket=" << q.largestBucket
+                          << "  avalanche_bias=" << q.avalancheBias
+                          << "  " << q.gbPerSec << " GB/s\n";
+            }
+        });
+    }
+
+    if (rows.empty()) {
+        std::cerr << "No keys loaded; nothing to analyze." << std::endl;
+        return 1;
+    }
+
+    namespace fs = std::filesystem;
+    fs::create_directories(fs::path(CSV_PATH).parent_path());
+    std::ofstream csv(CSV_PATH);
+    if (!csv) {
+        std::cerr << "Cannot open " << CSV_PATH << " for writing" << std::endl;
+        return 1;
+    }
+    csv << header << '\n';
+    for (const auto& row : rows)
+        csv << row << '\n';
+    std::cout << "\nResults written to: " << CSV_PATH << std::endl;
+
+    return 0;
+}
@@ -3,18 +3,38 @@
 //
 
 #include "HashTableDictionary.hpp"
+#include "HashFunctions.hpp"
+#include "TraceEvents.hpp"
 #include<iostream>
 #include<iomanip>
 #include<algorithm>
 #include<cassert>
-
-HashTableDictionary::HashTableDictionary(std::size_t large, PROBE_TYPE pType, bool doCompact, double compactionFloor):
-    TABLE_SIZE{large}, probeType{pType}, compactionTriggerEffectiveRate(compactionFloor), shouldCompact {doCompact} {
+#include<fstream>
+#include<sstream>
+#include<random>
+
+HashTableDictionary::HashTableDictionary(std::size_t large, PROBE_TYPE pType, bool doCompact, double compactionFloor,
+                                         HASH_POLICY hPolicy):
+    TABLE_SIZE{large}, probeType{pType}, hashPolicy{hPolicy}, compactionTriggerEffectiveRate(compactionFloor),
+    shouldCompact {doCompact} {
     hashTable.resize(large);
     hashTableMask.resize(large, AVAILABLE);
+
+    if (hashPolicy != POLYNOMIAL) {
+        std::random_device rd;
+        hashKey0 = (static_cast<std::uint64_t>(rd()) << 32) | rd();
+        hashKey1 = (static_cast<std::uint64_t>(rd()) << 32) | rd();
+    }
+}
+
+void HashTableDictionary::reseedHash(std::uint64_t k0, std::uint64_t k1) {
+    assert(numberOfActive == 0 && numberOfTombstones == 0);
+    hashKey0 = k0;
+    hashKey1 = k1;
 }
 
 void HashTableDictionary::clear() {
+    TraceSpan span("clear", "table", "table_size", static_cast<std::int64_t>(TABLE_SIZE));
     std::cout << "Clearing hash table...\n";
     hashTable.clear();
     hashTableMask.clear();
@@ -40,6 +60,10 @@ void HashTableDictionary::clear() {
 
      maxValuesInTable = 0;
 
+     numOperations = 0;
+     timeline.clear();
+     timelineSnapshots = 0;
+     timelineDropped = 0;
 }
 
 double HashTableDictionary::effectiveLoadFactor() const {
@@ -47,7 +71,11 @@ double HashTableDictionary::effectiveLoadFactor() const {
 }
 
 
-bool HashTableDictionary::insert( const std::string&  v ) {
+bool HashTableDictionary::insert( std::string_view v) {
+    return insert(v, hashedKey(v));
+}
+
+bool HashTableDictionary::insert( std::string_view v, const HashedKey& hashed ) {
     // Returns whether the insert was successful.
 
     if( numberOfActive == TABLE_SIZE) {
@@ -56,9 +84,11 @@ bool HashTableDictionary::insert( const std::string&  v ) {
         exit(1);
     }
     // std::cout << v << std::endl;
-    const std::size_t idx = memberHelper(v);
-    if (hashTableMask.at(idx) == USED && hashTable.at(idx) == v)
+    const std::size_t idx = memberHelper(v, hashed.home, hashed.step);
+    if (hashTableMask.at(idx) == USED && hashTable.at(idx) == v) {
+        noteOperation();
         return false;
+    }
 
     assert(hashTableMask.at(idx) != USED);
 
@@ -73,13 +103,21 @@ bool HashTableDictionary::insert( const std::string&  v ) {
         maxValuesInTable = numberOfActive;
 
 
-    if (shouldCompact && effectiveLoadFactor() > compactionTriggerEffectiveRate) {
+    // Re-inserts during a compaction must not start another one.
+    if (shouldCompact && !compacting && effectiveLoadFactor() > compactionTriggerEffectiveRate) {
         std::cout << "Compacting the table with effective rate at: " << compactionTriggerEffectiveRate << std::endl;
         printStats();
         compactTable();
         numCompactions++;
+        if (effectiveLoadFactor() > compactionTriggerEffectiveRate) {
+            std::cout << "Compaction left the load factor at " << effectiveLoadFactor() << ", above the trigger "
+                      << compactionTriggerEffectiveRate << "; every insert would compact. Terminating\n";
+            printStats();
+            exit(1);
+        }
     }
 
+    noteOperation();
     return true;
 }
 
@@ -87,14 +125,21 @@ std::size_t HashTableDictionary::size() const {
     return numberOfActive;
 }
 
-bool HashTableDictionary::remove(const std::string& v) {
+bool HashTableDictionary::remove(std::string_view v) {
+    return remove(v, hashedKey(v));
+}
+
+bool HashTableDictionary::remove(std::string_view v, const HashedKey& hashed) {
 //    std::cout << "In remove. Removing: " << v << std::endl;
-    auto idx = memberHelper(v);
-    if( hashTableMask.at(idx) != USED )
+    auto idx = memberHelper(v, hashed.home, hashed.step);
+    if( hashTableMask.at(idx) != USED ) {
+        noteOperation();
         return false;
+    }
 
     if (numberOfActive == TABLE_SIZE && hashTable.at(idx) != v) {
         std::cout << "Returning from remove because table is full and the item is not in the table.\n";
+        noteOperation();
         return false;
     }
 
@@ -104,6 +149,7 @@ bool HashTableDictionary::remove(const std::string& v) {
     numberOfActive--;
     numDeletes++;
 
+    noteOperation();
     return true;
 }
 
@@ -111,6 +157,8 @@ void HashTableDictionary::compactTable() {
 
     if (hashTable.size() == 0)
         return;
+    TraceSpan span("compactTable", "table", "table_size", static_cast<std::int64_t>(TABLE_SIZE),
+                   "active", numberOfActive);
 
     std::vector<std::string> newTable(hashTable.size());
     std::vector<ELEMENT_STATUS> newMask(hashTableMask.size(), AVAILABLE);
@@ -123,6 +171,10 @@ void HashTableDictionary::compactTable() {
     std::cout << "\tEffective load factor: " << effectiveLoadFactor() << std::endl;
     */
 
+    if (timelineEnabled)
+        takeTimelineSnapshot(BEFORE_COMPACTION);
+    compacting = true;
+
     beforeCompaction.clear();
     afterCompaction.clear();
     for (std::size_t i = 0; i < hashTableMask.size(); i++)
@@ -143,12 +195,16 @@ void HashTableDictionary::compactTable() {
     }
     numInserts = curNumInserts;
     totalProbes = curNumProbes;
+    compacting = false;
 
     for (std::size_t i = 0; i < hashTableMask.size(); i++)
         if (hashTableMask[i] == USED || hashTableMask[i] == DELETED)
             afterCompaction.push_back('1');
         else afterCompaction.push_back('0');
 
+    if (timelineEnabled)
+        takeTimelineSnapshot(AFTER_COMPACTION);
+
 
     /*
     std::cout << "\nAfter compacting the table:\n";
@@ -199,10 +255,15 @@ void HashTableDictionary::printBeforeAndAfterCompactionMaps() {
 
 }
 
-std::size_t HashTableDictionary::memberHelper(const std::string& v) {
+std::size_t HashTableDictionary::memberHelper(std::string_view v) {
+    std::size_t home, step;
+    hashSlots( v, home, step );
+    return memberHelper(v, home, step);
+}
+
+std::size_t HashTableDictionary::memberHelper(std::string_view v, std::size_t home, std::size_t step) {
 
-    std::size_t idx = primaryHashFunction( v );
-    std::size_t step = secondaryHashFunction( v );
+    std::size_t idx = home;
     std::int64_t numProbesForThisItem = 1;  // Accounting for the fact that the while loop's condition tests the table.
     std::size_t firstDeleteIdx = hashTable.size();
 
@@ -222,11 +283,16 @@ std::size_t HashTableDictionary::memberHelper(const std::string& v) {
     return hashTableMask.at(idx) == USED && hashTable.at(idx) == v ? idx : (firstDeleteIdx != hashTable.size() ? firstDeleteIdx : idx);
 }
 
-bool HashTableDictionary::member(const std::string& v )  {
+bool HashTableDictionary::member(std::string_view v)  {
+    return member(v, hashedKey(v));
+}
+
+bool HashTableDictionary::member(std::string_view v, const HashedKey& hashed)  {
     // Returns true if v a member. Otherwise, it returns false
 
-    auto idx = memberHelper(v);
+    auto idx = memberHelper(v, hashed.home, hashed.step);
     numLookups++;
+    noteOperation();
     return  hashTableMask.at(idx) == USED && hashTable.at(idx) == v;
 }
 
@@ -276,70 +342,208 @@ std::string HashTableDictionary::csvStats() {
            (shouldCompact ? "compaction_on" : "compaction_off");
 }
 
+HashTableDictionary::Counters HashTableDictionary::counters() const {
+    return {static_cast<std::int64_t>(TABLE_SIZE), numberOfActive, numberOfTombstones, totalProbes,
+            numInserts, numDeletes, numLookups, numFullScans, numCompactions};
+}
+
 void HashTableDictionary::printStats() const {
 
+    // Formatted locally and written at once, so tables replayed on different
+    // threads neither share stream state nor interleave their reports.
+    std::ostringstream out;
     const int width = 8;
-    std::cout << std::setw(width) << TABLE_SIZE << " table size: " << std::endl;
-    std::cout << std::setw(width) << numberOfTombstones << " cells marked as deleted."  << std::endl;
-    std::cout << std::setw(width) << numberOfActive << " active cells."  << std::endl;
-    std::cout << std::setw(width) << TABLE_SIZE - numberOfTombstones - numberOfActive << " available elements.\n";
-    std::cout << std::setw(width) << maxValuesInTable << " maximum number of values in the table ever." << std::endl;
-    std::cout << std::setw(width) << totalProbes << " total probes." << std::endl;
-
-    std::cout << std::endl;
-    std::cout << std::setw(width) << numInserts << " inserts."  << std::endl;
-    std::cout << std::setw(width) << numDeletes << " deletes."  << std::endl;
-    std::cout << std::setw(width) << numLookups << " lookups."  << std::endl;
-    std::cout << std::setw(width) << numFullScans << " full scans."  << std::endl;
-    std::cout << std::setw(width) << numCompactions << " compactions."  << std::endl;
-    std::cout << std::endl;
-    std::cout << std::setw(width) << static_cast<int>(static_cast<double>(TABLE_SIZE - numberOfTombstones - numberOfActive) / static_cast<double>(TABLE_SIZE) * 100) <<
+    out << std::setw(width) << TABLE_SIZE << " table size: " << std::endl;
+    out << std::setw(width) << numberOfTombstones << " cells marked as deleted."  << std::endl;
+    out << std::setw(width) << numberOfActive << " active cells."  << std::endl;
+    out << std::setw(width) << TABLE_SIZE - numberOfTombstones - numberOfActive << " available elements.\n";
+    out << std::setw(width) << maxValuesInTable << " maximum number of values in the table ever." << std::endl;
+    out << std::setw(width) << totalProbes << " total probes." << std::endl;
+
+    out << std::endl;
+    out << std::setw(width) << numInserts << " inserts."  << std::endl;
+    out << std::setw(width) << numDeletes << " deletes."  << std::endl;
+    out << std::setw(width) << numLookups << " lookups."  << std::endl;
+    out << std::setw(width) << numFullScans << " full scans."  << std::endl;
+    out << std::setw(width) << numCompactions << " compactions."  << std::endl;
+    out << std::endl;
+    out << std::setw(width) << static_cast<int>(static_cast<double>(TABLE_SIZE - numberOfTombstones - numberOfActive) / static_cast<double>(TABLE_SIZE) * 100) <<
         "% ratio of available elements." << std::endl;
 
 
-    std::cout << std::setw(width) << static_cast<int>(static_cast<double>(numberOfActive) / static_cast<double>(TABLE_SIZE) * 100) <<
+    out << std::setw(width) << static_cast<int>(static_cast<double>(numberOfActive) / static_cast<double>(TABLE_SIZE) * 100) <<
         "% load factor." << std::endl;
 
-    std::cout << std::setw(width) << static_cast<int>(static_cast<double>(numberOfActive + numberOfTombstones) / static_cast<double>(TABLE_SIZE) * 100) <<
+    out << std::setw(width) << static_cast<int>(static_cast<double>(numberOfActive + numberOfTombstones) / static_cast<double>(TABLE_SIZE) * 100) <<
         "% effective load factor." << std::endl;
 
 
-    std::cout << std::setw(width) << static_cast<int>(static_cast<double>(numberOfTombstones) / static_cast<double>(TABLE_SIZE) * 100) << "% tombstone fraction." <<  std::endl;
+    out << std::setw(width) << static_cast<int>(static_cast<double>(numberOfTombstones) / static_cast<double>(TABLE_SIZE) * 100) << "% tombstone fraction." <<  std::endl;
 
-    std::cout << std::endl;
+    out << std::endl;
 
-    std::cout << static_cast<double>(totalProbes) / static_cast<double>(numInserts + numDeletes + numLookups) <<
+    out << static_cast<double>(totalProbes) / static_cast<double>(numInserts + numDeletes + numLookups) <<
      " average number of probes";
 
     if (probeType == SINGLE)
-        std::cout << " (single probing, " << (shouldCompact ? "compaction on)." : "compaction off).") << std::endl;
+        out << " (single probing, " << (shouldCompact ? "compaction on)." : "compaction off).") << std::endl;
     else
-        std::cout << " (double probing, " << (shouldCompact ? "compaction on)." : "compaction off).") << std::endl;
+        out << " (double probing, " << (shouldCompact ? "compaction on)." : "compaction off).") << std::endl;
 
+    std::cout << out.str() << std::flush;
+}
 
+
+std::size_t HashTableDictionary::primaryHashFunction(std::string_view v) {
+    return polynomialModHash(v, 131, TABLE_SIZE);      // base 131, 0..LARGE_TWIN-1
 }
 
 
-std::size_t HashTableDictionary::primaryHashFunction(const std::string& v) {
+std::size_t HashTableDictionary::secondaryHashFunction(std::string_view v) {
+    if (probeType == SINGLE)
+        return 1;                // linear probing
+
+    return 1 + polynomialModHash(v, 257, TABLE_SIZE - 1);  // base 257, 1..LARGE_TWIN-1  (gcd(step, LARGE_TWIN)=1)
+}
+
+namespace {
+template<typename T>
+void appendRaw(std::vector<char>& buffer, T value) {
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+}
 
-    std::size_t idx = 0;
-    for (unsigned char c : v) {
-        idx = (idx * 131 + c) % TABLE_SIZE;     // base 131
+void HashTableDictionary::recordStructureTimeline(std::size_t snapshotEveryKOps, std::size_t maxSnapshots) {
+    timelineEnabled = true;
+    timelineInterval = snapshotEveryKOps;
+    timelineMaxSnapshots = maxSnapshots;
+    timelineSnapshots = 0;
+    timelineDropped = 0;
+    timeline.clear();
+}
+
+void HashTableDictionary::countTimelineOperation() {
+    // Re-inserts performed by compactTable() are not operations of the run.
+    if (compacting)
+        return;
+    numOperations++;
+    if (timelineInterval != 0 && numOperations % timelineInterval == 0)
+        takeTimelineSnapshot(PERIODIC);
+}
+
+void HashTableDictionary::takeTimelineSnapshot(TIMELINE_EVENT event) {
+    if (timelineSnapshots == timelineMaxSnapshots) {
+        timelineDropped++;
+        return;
+    }
+    timelineSnapshots++;
+
+    appendRaw<std::uint8_t>(timeline, event);
+    appendRaw<std::int64_t>(timeline, numOperations);
+    appendRaw<std::int64_t>(timeline, numberOfActive);
+    appendRaw<std::int64_t>(timeline, numberOfTombstones);
+    appendRaw<std::int64_t>(timeline, totalProbes);
+    appendRaw<std::int64_t>(timeline, numCompactions);
+    appendRaw<std::int64_t>(timeline, numFullScans);
+
+    // Probe sequences wrap, so start the scan at an available slot to keep a
+    // cluster that spans the end of the table in one piece.
+    std::uint64_t clusters[64] = {};
+    std::size_t start = 0;
+    while (start < TABLE_SIZE && hashTableMask[start] != AVAILABLE)
+        start++;
+    if (start == TABLE_SIZE) {
+        clusters[63 - __builtin_clzll(TABLE_SIZE)]++;
+    } else {
+        std::size_t run = 0;
+        for (std::size_t n = 1; n <= TABLE_SIZE; n++) {
+            const std::size_t i = (start + n) % TABLE_SIZE;
+            if (hashTableMask[i] != AVAILABLE) {
+                run++;
+            } else if (run != 0) {
+                clusters[63 - __builtin_clzll(run)]++;
+                run = 0;
+            }
+        }
+    }
+    std::uint8_t bins = 64;
+    while (bins > 0 && clusters[bins - 1] == 0)
+        bins--;
+    appendRaw<std::uint8_t>(timeline, bins);
+    for (std::uint8_t b = 0; b < bins; b++)
+        appendRaw<std::uint64_t>(timeline, clusters[b]);
+
+    const std::size_t maskStart = timeline.size();
+    timeline.resize(maskStart + (TABLE_SIZE + 3) / 4, 0);
+    for (std::size_t i = 0; i < TABLE_SIZE; i++) {
+        const unsigned code = hashTableMask[i] == USED ? 2 : (hashTableMask[i] == DELETED ? 1 : 0);
+        timeline[maskStart + i / 4] = static_cast<char>(timeline[maskStart + i / 4] | (code << (2 * (i % 4))));
     }
-    return idx;                                 // 0..LARGE_TWIN-1
 }
 
+bool HashTableDictionary::writeStructureTimeline(const std::string& path) const {
+    std::vector<char> header;
+    header.insert(header.end(), {'H', 'T', 'T', 'L'});
+    appendRaw<std::uint32_t>(header, 1);
+    appendRaw<std::uint64_t>(header, TABLE_SIZE);
+    appendRaw<std::uint8_t>(header, probeType);
+    appendRaw<std::uint8_t>(header, shouldCompact);
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cout << "Unable to open " << path << " for the structure timeline.\n";
+        return false;
+    }
+    file.write(header.data(), static_cast<std::streamsize>(header.size()));
+    file.write(timeline.data(), static_cast<std::streamsize>(timeline.size()));
+    if (timelineDropped != 0)
+        std::cout << "Structure timeline kept " << timelineSnapshots << " snapshots; " << timelineDropped
+                  << " later ones were dropped.\n";
+    return static_cast<bool>(file);
+}
 
-std::size_t HashTableDictionary::secondaryHashFunction(const std::string& v) {
-    if (probeType == SINGLE)
-        return 1;                // linear probing
+void HashTableDictionary::hashSlots(std::string_view v, std::size_t& home, std::size_t& step) {
+    if (hashPolicy == POLYNOMIAL) {
+        home = primaryHashFunction(v);
+        step = secondaryHashFunction(v);
+        return;
+    }
 
+    // One keyed 64-bit hash supplies both the home slot and the step.
+    const std::uint64_t h = hashPolicy == SIPHASH ? sipHash24(v, hashKey0, hashKey1) : fastHash64(v, hashKey0);
+    home = h % TABLE_SIZE;
+    step = probeType == SINGLE ? 1 : 1 + (h / TABLE_SIZE) % (TABLE_SIZE - 1);
+}
 
-    std::size_t idx = 0;
-    for (unsigned char c : v) {
-        idx = (idx * 257 + c) % (TABLE_SIZE - 1);      // base 257
+// home and step only; the scalar paths never look at the fingerprint.
+HashTableDictionary::HashedKey HashTableDictionary::hashedKey(std::string_view v) {
+    HashedKey hashed{0, 0, 0};
+    hashSlots(v, hashed.home, hashed.step);
+    return hashed;
+}
+
+void HashTableDictionary::hashBatch(const std::string_view* keys, std::size_t count, HashedKey* out) const {
+    if (hashPolicy == POLYNOMIAL) {
+        // Hashed in chunks through stack buffers, so a call never allocates.
+        constexpr std::size_t chunk = 64;
+        std::size_t homes[chunk], steps[chunk];
+        std::uint32_t fingerprints[chunk];
+        for (std::size_t first = 0; first < count; first += chunk) {
+            const std::size_t n = std::min(chunk, count - first);
+            polynomialModHashBatch(keys + first, n, TABLE_SIZE, TABLE_SIZE - 1, homes, steps, fingerprints);
+            for (std::size_t i = 0; i < n; i++)
+                out[first + i] = {homes[i], probeType == SINGLE ? 1 : 1 + steps[i], fingerprints[i]};
+        }
+        return;
+    }
+
+    for (std::size_t i = 0; i < count; i++) {
+        const std::uint64_t h = hashPolicy == SIPHASH ? sipHash24(keys[i], hashKey0, hashKey1)
+                                                      : fastHash64(keys[i], hashKey0);
+        out[i] = {h % TABLE_SIZE, probeType == SINGLE ? 1 : 1 + (h / TABLE_SIZE) % (TABLE_SIZE - 1),
+                  static_cast<std::uint32_t>(h >> 32)};
     }
-    return 1 + idx;                                    // 1..LARGE_TWIN-1  (gcd(step, LARGE_TWIN)=1)
 }
 
 void inRed(char c) {
@@ -391,3 +595,46 @@ void HashTableDictionary::printMask() {
     std::cout << "\nElements available map.\n";
     printMask(AVAILABLE);
 }
+
+bool HashTableDictionary::exportStructureMap(const std::string& path, std::size_t slotsPerPixel,
+                                             std::size_t imageWidth) const {
+    if (slotsPerPixel == 0 || imageWidth == 0) {
+        std::cout << "exportStructureMap: slotsPerPixel and imageWidth must be positive.\n";
+        return false;
+    }
+
+    const std::size_t numPixels = (TABLE_SIZE + slotsPerPixel - 1) / slotsPerPixel;
+    const std::size_t width = std::min(imageWidth, std::max<std::size_t>(numPixels, 1));
+    const std::size_t height = std::max<std::size_t>((numPixels + width - 1) / width, 1);
+
+    const std::string header = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+    std::string image(header.size() + width * height * 3, '\0');  // padding pixels stay black
+    std::copy(header.begin(), header.end(), image.begin());
+
+    std::size_t out = header.size();
+    for (std::size_t start = 0; start < TABLE_SIZE; start += slotsPerPixel) {
+        const std::size_t end = std::min(start + slotsPerPixel, TABLE_SIZE);
+        std::size_t used = 0, deleted = 0, available = 0;
+        for (std::size_t i = start; i < end; i++) {
+            if (hashTableMask[i] == USED)
+                used++;
+            else if (hashTableMask[i] == DELETED)
+                deleted++;
+            else
+                available++;
+        }
+        // used = (255, 0, 0), deleted = (0, 255, 0), available = (255, 255, 0)
+        const std::size_t n = end - start;
+        image[out++] = static_cast<char>((used + available) * 255 / n);
+        image[out++] = static_cast<char>((deleted + available) * 255 / n);
+        image[out++] = 0;
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cout << "Unable to open " << path << " for the structure map.\n";
+        return false;
+    }
+    file.write(image.data(), static_cast<std::streamsize>(image.size()));
+    return static_cast<bool>(file);
+}
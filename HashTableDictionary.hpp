@@ -7,22 +7,52 @@
 
 #include<vector>
 #include<string>
+#include<cstdint>
+#include<string_view>
 
 class HashTableDictionary {
 
     enum ELEMENT_STATUS {AVAILABLE, DELETED, USED};
+    enum TIMELINE_EVENT {PERIODIC, BEFORE_COMPACTION, AFTER_COMPACTION};
 
 public:
     enum PROBE_TYPE {SINGLE, DOUBLE};
+    // POLYNOMIAL is the original unseeded base-131/257 hash. SIPHASH and FAST
+    // are keyed by a per-table random seed; SIPHASH resists collision flooding
+    // from untrusted keys, FAST is for trusted keys only.
+    enum HASH_POLICY {POLYNOMIAL, SIPHASH, FAST};
 
     HashTableDictionary( std::size_t tableSize_,
-        PROBE_TYPE probeType, bool doCompact=false, double compactionTriggerRate=0.95);
-
-
-
-    bool insert( const std::string& v );
-    bool member( const std::string& v );
-    bool remove( const std::string& v);
+        PROBE_TYPE probeType, bool doCompact=false, double compactionTriggerRate=0.95,
+        HASH_POLICY hashPolicy=POLYNOMIAL);
+
+    // Probe-sequence start and step for a key, plus a 32-bit fingerprint that
+    // does not depend on the table size.
+    struct HashedKey {
+        std::size_t home;
+        std::size_t step;
+        std::uint32_t fingerprint;
+    };
+
+    // Hashes `count` keys at once. Under POLYNOMIAL this runs the AVX2 batch
+    // hash (see polynomialModHashBatch); the keyed policies hash key by key.
+    // home/step match what insert, member and remove would probe.
+    void hashBatch(const std::string_view* keys, std::size_t count, HashedKey* out) const;
+
+    // Replaces the random per-table seed, e.g. to make a keyed run reproducible.
+    // Only valid while the table is empty.
+    void reseedHash(std::uint64_t k0, std::uint64_t k1);
+
+
+
+    bool insert( std::string_view v );
+    bool member( std::string_view v );
+    bool remove( std::string_view v );
+    // The same operations probing from v's hashBatch() result, so a replay
+    // can hash its keys a batch at a time. `hashed` must come from this table.
+    bool insert( std::string_view v, const HashedKey& hashed );
+    bool member( std::string_view v, const HashedKey& hashed );
+    bool remove( std::string_view v, const HashedKey& hashed );
     [[nodiscard]] bool empty() const;
     [[nodiscard]] std::size_t size() const;
     void printStats() const;
@@ -33,26 +63,91 @@ public:
     void printBeforeAndAfterCompactionMaps();
     void printActiveDeleteMap();
 
+    // Renders the slot map as a binary PPM (P6) image, one pixel per block of
+    // slotsPerPixel slots, laid out imageWidth pixels per row. A pixel blends
+    // red (used), green (deleted) and yellow (available) by the fraction of each
+    // in its block, so slotsPerPixel=1 reproduces printMask()'s colors. The
+    // image is assembled in memory and written with a single write.
+    bool exportStructureMap(const std::string& path, std::size_t slotsPerPixel = 1,
+                            std::size_t imageWidth = 1024) const;
+
+    // Structure timeline: a binary record of the table taken every
+    // snapshotEveryKOps operations (0 = compactions only) and immediately before
+    // and after each compaction, up to maxSnapshots of them (each holds the
+    // whole mask, so memory grows with table_size x snapshots; later ones are
+    // dropped and counted). Operations are counted only while recording.
+    // clear() discards recorded snapshots but keeps the recorder enabled.
+    // File layout, all integers in native byte order:
+    //   header: "HTTL" u32 version(1) u64 table_size u8 probe_type u8 compaction
+    //   record: u8 event (0 periodic, 1 before compaction, 2 after compaction)
+    //           i64 operations, active, tombstones, total_probes, compactions, full_scans
+    //           u8 bins, then u64 x bins: clusters of non-available slots whose
+    //              length has floor(log2(length)) == bin (clusters wrap around)
+    //           ceil(table_size / 4) bytes: 2 bits per slot, slot i in bits
+    //              2*(i%4)..2*(i%4)+1 of byte i/4 (0 available, 1 deleted, 2 used)
+    void recordStructureTimeline(std::size_t snapshotEveryKOps, std::size_t maxSnapshots = 256);
+    bool writeStructureTimeline(const std::string& path) const;
+
     void clear();
     std::string csvStats();
     static std::string csvStatsHeader();
 
+    // The running totals behind csvStats(), for sampling the table while a
+    // trace is being replayed.
+    struct Counters {
+        std::int64_t tableSize;
+        std::int64_t active;
+        std::int64_t tombstones;
+        std::int64_t totalProbes;
+        std::int64_t inserts;
+        std::int64_t deletes;
+        std::int64_t lookups;
+        std::int64_t fullScans;
+        std::int64_t compactions;
+    };
+    [[nodiscard]] Counters counters() const;
+
 
 private:
+    // Gives the microbenchmarks (Microbenchmarks.cpp) direct access to the
+    // probe loop and compaction so each can be timed on its own.
+    friend struct HashTableInternals;
+
     std::size_t  TABLE_SIZE;
     PROBE_TYPE probeType;
+    HASH_POLICY hashPolicy;
+    std::uint64_t hashKey0 = 0, hashKey1 = 0;
 
     std::vector<std::string> hashTable;
     std::vector<ELEMENT_STATUS> hashTableMask;
 
     std::vector<char> beforeCompaction, afterCompaction;
 
-    std::size_t primaryHashFunction( const std::string&  v );
-    std::size_t secondaryHashFunction( const std::string&  v );
-    std::size_t memberHelper( const std::string& v );
+    std::size_t primaryHashFunction( std::string_view v );
+    std::size_t secondaryHashFunction( std::string_view v );
+    void hashSlots( std::string_view v, std::size_t& home, std::size_t& step );
+    std::size_t memberHelper( std::string_view v );
+    std::size_t memberHelper( std::string_view v, std::size_t home, std::size_t step );
+    HashedKey hashedKey( std::string_view v );
     [[nodiscard]] double effectiveLoadFactor() const;
 
     void compactTable();
+    // Counts an operation for the structure timeline; free when not recording.
+    void noteOperation() {
+        if (timelineEnabled)
+            countTimelineOperation();
+    }
+    void countTimelineOperation();
+    void takeTimelineSnapshot(TIMELINE_EVENT event);
+
+    bool timelineEnabled = false;
+    bool compacting = false;
+    std::size_t timelineInterval = 0;
+    std::size_t timelineMaxSnapshots = 0;
+    std::size_t timelineSnapshots = 0;
+    std::size_t timelineDropped = 0;
+    std::int64_t numOperations = 0;
+    std::vector<char> timeline;
 
     double compactionTriggerEffectiveRate = 0.95;
 
@@ -0,0 +1,165 @@
+/**
+ * LRUTrace.cpp - Access-stream construction and LRU simulation shared by the
+ * trace generators.
+ */
+
+#include "LRUTrace.hpp"
+#include "BinaryTrace.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <list>
+#include <unordered_map>
+#include <random>
+#include <algorithm>
+
+// ============================================================================
+// Corpus Loading
+// ============================================================================
+
+bool loadCorpusWords(const std::string& corpusPath,
+                     std::size_t count,
+                     std::vector<std::string>& words) {
+    words.clear();
+    words.reserve(count);
+
+    std::ifstream in(corpusPath);
+    if (!in.is_open()) {
+        std::cerr << "Cannot open corpus file: " << corpusPath << std::endl;
+        return false;
+    }
+
+    std::string line;
+    while (words.size() < count && std::getline(in, line)) {
+        // Skip empty lines
+        if (line.empty()) continue;
+        // Each line is a complete key (two words)
+        words.push_back(line);
+    }
+
+    if (words.size() < count) {
+        std::cerr << "Warning: Corpus has only " << words.size()
+                  << " entries, needed " << count << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// ============================================================================
+// Access Stream Builder
+// ============================================================================
+
+std::vector<std::string> buildAccessStream(const std::vector<std::string>& corpus,
+                                           std::size_t N,
+                                           unsigned int seed) {
+    std::vector<std::string> stream;
+    stream.reserve(12 * N);
+
+    // Pool 1: first N words, each appearing once
+    for (std::size_t i = 0; i < N; ++i) {
+        stream.push_back(corpus[i]);
+    }
+
+    // Pool 2: next N words (indices N to 2N-1), each appearing 5 times
+    for (std::size_t i = N; i < 2 * N; ++i) {
+        for (int j = 0; j < 5; ++j) {
+            stream.push_back(corpus[i]);
+        }
+    }
+
+    // Pool 3: next 2N words (indices 2N to 4N-1), each appearing 3 times
+    for (std::size_t i = 2 * N; i < 4 * N; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            stream.push_back(corpus[i]);
+        }
+    }
+
+    // Shuffle deterministically
+    std::mt19937 rng(seed);
+    std::shuffle(stream.begin(), stream.end(), rng);
+
+    return stream;
+}
+
+// ============================================================================
+// LRU Trace Generator
+// ============================================================================
+
+void forEachLRUOperation(const std::vector<std::string>& accessStream,
+                         std::size_t capacity,
+                         const std::function<void(char, const std::string&)>& emit) {
+
+    // LRU data structures
+    std::list<std::string> lruList;  // front = MRU, back = LRU
+    std::unordered_map<std::string, std::list<std::string>::iterator> residentMap;
+
+    for (const auto& key : accessStream) {
+        auto it = residentMap.find(key);
+
+        if (it != residentMap.end()) {
+            // HIT: key is already resident
+            // Move to MRU position (front of list)
+            lruList.erase(it->second);
+            lruList.push_front(key);
+            it->second = lruList.begin();
+
+            // Emit lookup operation
+            emit('L', key);
+
+        } else if (residentMap.size() < capacity) {
+            // MISS, but space available
+            // Insert at MRU position
+            lruList.push_front(key);
+            residentMap[key] = lruList.begin();
+
+            // Emit insert operation
+            emit('I', key);
+
+        } else {
+            // MISS, table is full - need to evict LRU
+            // Get the LRU key (back of list)
+            const std::string& victim = lruList.back();
+
+            // Emit evict operation
+            emit('E', victim);
+
+            // Remove victim from map and list
+            residentMap.erase(victim);
+            lruList.pop_back();
+
+            // Insert new key at MRU position
+            lruList.push_front(key);
+            residentMap[key] = lruList.begin();
+
+            // Emit insert operation
+            emit('I', key);
+        }
+    }
+}
+
+void generateLRUTrace(const std::vector<std::string>& accessStream,
+                      std::size_t capacity,
+                      std::ostream& out,
+                      const std::string& profile,
+                      int seed) {
+
+    // Write header
+    out << profile << " " << capacity << " " << seed << "\n";
+
+    forEachLRUOperation(accessStream, capacity, [&out](char op, const std::string& key) {
+        out << op << " " << key << "\n";
+    });
+}
+
+bool generateLRUBinaryTrace(const std::vector<std::string>& accessStream,
+                            std::size_t capacity,
+                            const std::string& outputPath,
+                            const std::string& profile,
+                            int seed) {
+    BinaryTraceWriter writer(profile, capacity, seed);
+    forEachLRUOperation(accessStream, capacity, [&writer](char op, const std::string& key) {
+        writer.add(op, key);
+    });
+    return writer.write(outputPath);
+}
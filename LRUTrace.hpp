@@ -0,0 +1,47 @@
+/**
+ * LRUTrace.hpp - Access-stream construction and LRU simulation shared by the
+ * trace generators.
+ */
+
+#ifndef HASHTABLESOPENADDRESSING_LRUTRACE_HPP
+#define HASHTABLESOPENADDRESSING_LRUTRACE_HPP
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Reads the first `count` non-empty lines of the corpus; each line is a key.
+bool loadCorpusWords(const std::string& corpusPath,
+                     std::size_t count,
+                     std::vector<std::string>& words);
+
+// 12N accesses over 4N distinct keys (N once, N five times, 2N three times),
+// shuffled deterministically with `seed`.
+std::vector<std::string> buildAccessStream(const std::vector<std::string>& corpus,
+                                           std::size_t N,
+                                           unsigned int seed);
+
+// Simulates an LRU cache of `capacity` keys over the access stream and calls
+// emit('L', key) for every hit, emit('I', key) for every miss and
+// emit('E', victim) for every eviction.
+void forEachLRUOperation(const std::vector<std::string>& accessStream,
+                         std::size_t capacity,
+                         const std::function<void(char, const std::string&)>& emit);
+
+// Writes the "<profile> <capacity> <seed>" header and the LRU operations.
+void generateLRUTrace(const std::vector<std::string>& accessStream,
+                      std::size_t capacity,
+                      std::ostream& out,
+                      const std::string& profile,
+                      int seed);
+
+// Same trace written directly in the .btrace format (see BinaryTrace.hpp).
+bool generateLRUBinaryTrace(const std::vector<std::string>& accessStream,
+                            std::size_t capacity,
+                            const std::string& outputPath,
+                            const std::string& profile,
+                            int seed);
+
+#endif //HASHTABLESOPENADDRESSING_LRUTRACE_HPP
@@ -9,12 +9,12 @@
 #include <sstream>
 #include <string>
 #include <vector>
-#include <list>
-#include <unordered_map>
-#include <random>
 #include <algorithm>
 #include <sys/stat.h>
 
+#include "LRUTrace.hpp"
+#include "TableSizes.hpp"
+
 // ============================================================================
 // Configuration
 // ============================================================================
@@ -22,140 +22,14 @@ constexpr int DEFAULT_SEED = 23;
 const std::string DEFAULT_CORPUS = "20980712_uniq_words.txt";
 const std::string OUTPUT_DIR = "traceFiles";
 
-// N values to generate traces for (2^10 through 2^20)
-const std::vector<std::size_t> N_VALUES = {
-    1024, 2048, 4096, 8192, 16384, 32768, 65536, 131072, 262144, 524288, 1048576
-};
-
-// ============================================================================
-// Corpus Loading
-// ============================================================================
-
-bool loadCorpusWords(const std::string& corpusPath,
-                     std::size_t count,
-                     std::vector<std::string>& words) {
-    words.clear();
-    words.reserve(count);
-
-    std::ifstream in(corpusPath);
-    if (!in.is_open()) {
-        std::cerr << "Cannot open corpus file: " << corpusPath << std::endl;
-        return false;
-    }
-
-    std::string line;
-    while (words.size() < count && std::getline(in, line)) {
-        // Skip empty lines
-        if (line.empty()) continue;
-        // Each line is a complete key (two words)
-        words.push_back(line);
-    }
-
-    if (words.size() < count) {
-        std::cerr << "Warning: Corpus has only " << words.size()
-                  << " entries, needed " << count << std::endl;
-        return false;
-    }
-
-    return true;
-}
-
-// ============================================================================
-// Access Stream Builder
-// ============================================================================
-
-std::vector<std::string> buildAccessStream(const std::vector<std::string>& corpus,
-                                           std::size_t N,
-                                           unsigned int seed) {
-    std::vector<std::string> stream;
-    stream.reserve(12 * N);
-
-    // Pool 1: first N words, each appearing once
-    for (std::size_t i = 0; i < N; ++i) {
-        stream.push_back(corpus[i]);
-    }
-
-    // Pool 2: next N words (indices N to 2N-1), each appearing 5 times
-    for (std::size_t i = N; i < 2 * N; ++i) {
-        for (int j = 0; j < 5; ++j) {
-            stream.push_back(corpus[i]);
-        }
-    }
-
-    // Pool 3: next 2N words (indices 2N to 4N-1), each appearing 3 times
-    for (std::size_t i = 2 * N; i < 4 * N; ++i) {
-        for (int j = 0; j < 3; ++j) {
-            stream.push_back(corpus[i]);
-        }
-    }
-
-    // Shuffle deterministically
-    std::mt19937 rng(seed);
-    std::shuffle(stream.begin(), stream.end(), rng);
-
-    return stream;
-}
-
-// ============================================================================
-// LRU Trace Generator
-// ============================================================================
-
-void generateLRUTrace(const std::vector<std::string>& accessStream,
-                      std::size_t capacity,
-                      std::ostream& out,
-                      const std::string& profile,
-                      int seed) {
-
-    // Write header
-    out << profile << " " << capacity << " " << seed << "\n";
-
-    // LRU data structures
-    std::list<std::string> lruList;  // front = MRU, back = LRU
-    std::unordered_map<std::string, std::list<std::string>::iterator> residentMap;
-
-    for (const auto& key : accessStream) {
-        auto it = residentMap.find(key);
-
-        if (it != residentMap.end()) {
-            // HIT: key is already resident
-            // Move to MRU position (front of list)
-            lruList.erase(it->second);
-            lruList.push_front(key);
-            it->second = lruList.begin();
-
-            // Emit insert (access) operation
-            out << "I " << key << "\n";
-
-        } else if (residentMap.size() < capacity) {
-            // MISS, but space available
-            // Insert at MRU position
-            lruList.push_front(key);
-            residentMap[key] = lruList.begin();
-
-            // Emit insert operation
-            out << "I " << key << "\n";
-
-        } else {
-            // MISS, table is full - need to evict LRU
-            // Get the LRU key (back of list)
-            const std::string& victim = lruList.back();
-
-            // Emit evict operation
-            out << "E " << victim << "\n";
-
-            // Remove victim from map and list
-            residentMap.erase(victim);
-            lruList.pop_back();
-
-            // Insert new key at MRU position
-            lruList.push_front(key);
-            residentMap[key] = lruList.begin();
-
-            // Emit insert operation
-            out << "I " << key << "\n";
-        }
-    }
+// N values to generate traces for: the standard capacities 2^10 through 2^20
+std::vector<std::size_t> standardNValues() {
+    std::vector<std::size_t> values;
+    for (const auto& entry : N_to_M_mapping)
+        values.push_back(static_cast<std::size_t>(entry.first));
+    return values;
 }
+const std::vector<std::size_t> N_VALUES = standardNValues();
 
 // ============================================================================
 // Main Program
@@ -173,6 +47,10 @@ void printUsage(const char* progName) {
     std::cerr << "  Generate single trace:" << std::endl;
     std::cerr << "    " << progName << " 20980712_uniq_words.txt 1024" << std::endl;
     std::cerr << "    " << progName << " 20980712_uniq_words.txt 1024 23 my_trace.trace" << std::endl;
+    std::cerr << "  Any other N needs all four arguments:" << std::endl;
+    std::cerr << "    " << progName << " 20980712_uniq_words.txt 3000 23 my_trace.trace" << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "  Add --binary anywhere to write .btrace files instead of text." << std::endl;
 }
 
 bool isValidN(std::size_t N) {
@@ -183,6 +61,19 @@ bool isValidN(std::size_t N) {
 }
 
 int main(int argc, char* argv[]) {
+    // --binary may appear anywhere and selects the .btrace format.
+    std::vector<char*> args;
+    bool binary = false;
+    for (int i = 0; i < argc; i++) {
+        if (std::string(argv[i]) == "--binary")
+            binary = true;
+        else
+            args.push_back(argv[i]);
+    }
+    argc = static_cast<int>(args.size());
+    argv = args.data();
+    const std::string extension = binary ? ".btrace" : ".trace";
+
     if (argc < 2 || argc > 5) {
         printUsage(argv[0]);
         return 1;
@@ -190,14 +81,16 @@ int main(int argc, char* argv[]) {
 
     std::string corpusPath = argv[1];
 
-    // Check if second argument looks like an N value
+    // Check if second argument looks like an N value. A bare N must be one of
+    // the standard capacities (otherwise it is the seed); with all four
+    // arguments given, any positive N is taken.
     bool singleMode = false;
     std::size_t singleN = 0;
 
     if (argc >= 3) {
         try {
             singleN = std::stoull(argv[2]);
-            if (isValidN(singleN)) {
+            if (isValidN(singleN) || (argc == 5 && singleN > 0)) {
                 singleMode = true;
             }
         } catch (...) {
@@ -209,7 +102,7 @@ int main(int argc, char* argv[]) {
         // Single trace generation mode
         int seed = (argc >= 4) ? std::stoi(argv[3]) : DEFAULT_SEED;
         std::string outputFile = (argc >= 5) ? argv[4] :
-            "lru_profile_N_" + std::to_string(singleN) + "_S_" + std::to_string(seed) + ".trace";
+            "lru_profile_N_" + std::to_string(singleN) + "_S_" + std::to_string(seed) + extension;
 
         // Load corpus (need 4N words)
         std::vector<std::string> corpus;
@@ -223,15 +116,19 @@ int main(int argc, char* argv[]) {
         std::cout << "  Total accesses: " << accessStream.size() << std::endl;
 
         // Generate trace
-        std::ofstream outFile(outputFile);
-        if (!outFile.is_open()) {
-            std::cerr << "Cannot create output file: " << outputFile << std::endl;
-            return 1;
-        }
-
         std::cout << "Generating trace..." << std::endl;
-        generateLRUTrace(accessStream, singleN, outFile, "lru_profile", seed);
-        outFile.close();
+        if (binary) {
+            if (!generateLRUBinaryTrace(accessStream, singleN, outputFile, "lru_profile", seed))
+                return 1;
+        } else {
+            std::ofstream outFile(outputFile);
+            if (!outFile.is_open()) {
+                std::cerr << "Cannot create output file: " << outputFile << std::endl;
+                return 1;
+            }
+            generateLRUTrace(accessStream, singleN, outFile, "lru_profile", seed);
+            outFile.close();
+        }
 
         std::cout << "Trace written to: " << outputFile << std::endl;
 
@@ -260,7 +157,7 @@ int main(int argc, char* argv[]) {
         // Generate traces for each N
         for (std::size_t N : N_VALUES) {
             std::string filename = "lru_profile_N_" + std::to_string(N) +
-                                   "_S_" + std::to_string(seed) + ".trace";
+                                   "_S_" + std::to_string(seed) + extension;
             std::string filepath = outputDir + "/" + filename;
 
             std::cout << "\nGenerating trace for N = " << N << "..." << std::endl;
@@ -270,15 +167,20 @@ int main(int argc, char* argv[]) {
             std::cout << "  Access stream size: " << accessStream.size() << std::endl;
 
             // Generate trace
-            std::ofstream outFile(filepath);
-            if (!outFile.is_open()) {
-                std::cerr << "Cannot create: " << filepath << std::endl;
-                continue;
+            if (binary) {
+                if (!generateLRUBinaryTrace(accessStream, N, filepath, "lru_profile", seed))
+                    continue;
+            } else {
+                std::ofstream outFile(filepath);
+                if (!outFile.is_open()) {
+                    std::cerr << "Cannot create: " << filepath << std::endl;
+                    continue;
+                }
+
+                generateLRUTrace(accessStream, N, outFile, "lru_profile", seed);
+                outFile.close();
             }
 
-            generateLRUTrace(accessStream, N, outFile, "lru_profile", seed);
-            outFile.close();
-
             std::cout << "  Written: " << filename << std::endl;
         }
 
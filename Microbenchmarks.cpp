@@ -0,0 +1,398 @@
+/**
+ * Microbenchmarks
+ *
+ * Times the table's internals one at a time, where a trace replay mixes them:
+ *   - each hash function over the corpus keys
+ *   - memberHelper() hits and misses at controlled load and tombstone fractions
+ *   - insert() of fresh keys at the same fractions
+ *   - compactTable() and clear() at every table size in N_to_M_mapping
+ *
+ * Every benchmark is measured as `samples` independent samples. A sample times
+ * a batch of operations on a freshly built table state and yields ns/op; the
+ * report gives the median, mean, standard deviation and minimum of the samples.
+ * Table keys are two-word keys built from the corpus, as in the LRU traces.
+ *
+ * Usage: bench [corpus] [samples] [max_table_size]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include <filesystem>
+
+#include "HashTableDictionary.hpp"
+#include "HashFunctions.hpp"
+#include "TableSizes.hpp"
+
+// ============================================================================
+// Configuration
+// ============================================================================
+const std::string DEFAULT_CORPUS = "../all_uniq_tokens_imdb_and_newsgroups.txt";
+const std::string CSV_PATH = "../csvs/microbench.csv";
+
+constexpr int DEFAULT_SAMPLES = 15;
+constexpr std::size_t DEFAULT_MAX_TABLE_SIZE = 1310809;
+
+// The memberHelper/insert grid runs at the table size used for N = 16384.
+constexpr int PROBE_GRID_N = 16384;
+const std::vector<double> LOAD_FRACTIONS = {0.25, 0.50, 0.75, 0.90};
+const std::vector<double> TOMBSTONE_FRACTIONS = {0.0, 0.10, 0.25};
+constexpr double MAX_OCCUPIED_FRACTION = 0.95;
+
+// Fresh keys inserted per insert() sample, as a fraction of the table size;
+// small enough that the load and tombstone fractions barely move.
+constexpr double INSERT_BATCH_FRACTION = 0.005;
+
+// State that compactTable() and clear() start from.
+constexpr double COMPACT_LOAD_FRACTION = 0.50;
+constexpr double COMPACT_TOMBSTONE_FRACTION = 0.25;
+
+constexpr std::uint64_t BENCH_KEY0 = 0x0706050403020100ULL;
+constexpr std::uint64_t BENCH_KEY1 = 0x0f0e0d0c0b0a0908ULL;
+
+volatile std::size_t benchSink = 0;  // keeps timed results observable
+
+// ============================================================================
+// Access to the table's private members
+// ============================================================================
+struct HashTableInternals {
+    static std::size_t memberHelper(HashTableDictionary& table, std::string_view key) {
+        return table.memberHelper(key);
+    }
+    static void compactTable(HashTableDictionary& table) {
+        table.compactTable();
+    }
+};
+
+// ============================================================================
+// Sampling
+// ============================================================================
+struct SampleStats {
+    double medianNs = 0;
+    double meanNs = 0;
+    double stddevNs = 0;
+    double minNs = 0;
+};
+
+SampleStats summarize(std::vector<double> samples) {
+    SampleStats s;
+    std::sort(samples.begin(), samples.end());
+    const std::size_t n = samples.size();
+    s.minNs = samples.front();
+    s.medianNs = n % 2 == 1 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2.0;
+    for (double v : samples)
+        s.meanNs += v;
+    s.meanNs /= static_cast<double>(n);
+    double squares = 0;
+    for (double v : samples)
+        squares += (v - s.meanNs) * (v - s.meanNs);
+    s.stddevNs = n > 1 ? std::sqrt(squares / static_cast<double>(n - 1)) : 0.0;
+    return s;
+}
+
+// Runs setup() untimed, then times body(), which performs `ops` operations.
+// Both are taken by type so the timed code is inlined, not called indirectly.
+template <typename Setup, typename Body>
+double timeSample(Setup&& setup, Body&& body, std::size_t ops) {
+    using clock = std::chrono::steady_clock;
+    setup();
+    const auto t0 = clock::now();
+    body();
+    const auto t1 = clock::now();
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()) /
+           static_cast<double>(ops);
+}
+
+// ============================================================================
+// Keys and Table States
+// ============================================================================
+bool loadCorpus(const std::string& path, std::vector<std::string>& words) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        std::cerr << "Cannot open corpus: " << path << std::endl;
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (!line.empty())
+            words.push_back(line);
+    }
+    return true;
+}
+
+// `count` distinct two-word keys, shuffled. Key i joins word i % W with the
+// word i / W + 1 places after it, so keys stay distinct up to W * (W - 1).
+std::vector<std::string> twoWordKeys(const std::vector<std::string>& words, std::size_t count) {
+    const std::size_t W = words.size();
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    for (std::size_t i = 0; i < count; i++)
+        keys.push_back(words[i % W] + " " + words[(i % W + i / W + 1) % W]);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+    return keys;
+}
+
+// Fills `table` so that loadFraction of its slots are active and
+// tombstoneFraction are tombstones: keys[0, active) stay resident and the
+// next `tombstones` keys are inserted and then removed. Because the keys are
+// shuffled, the tombstones land on hash-random slots.
+void buildState(HashTableDictionary& table, const std::vector<std::string>& keys, std::size_t tableSize,
+                double loadFraction, double tombstoneFraction) {
+    const auto active = static_cast<std::size_t>(loadFraction * static_cast<double>(tableSize));
+    const auto tombstones = static_cast<std::size_t>(tombstoneFraction * static_cast<double>(tableSize));
+    table.clear();
+    for (std::size_t i = 0; i < active + tombstones; i++)
+        table.insert(keys[i]);
+    for (std::size_t i = active; i < active + tombstones; i++)
+        table.remove(keys[i]);
+}
+
+// ============================================================================
+// Benchmarks
+// ============================================================================
+struct BenchResult {
+    std::string benchmark;
+    std::string variant;
+    std::size_t tableSize = 0;
+    double loadFraction = 0;
+    double tombstoneFraction = 0;
+    std::size_t opsPerSample = 0;
+    double probesPerOp = 0;
+    SampleStats stats;
+};
+
+class Microbenchmarks {
+public:
+    Microbenchmarks(std::vector<std::string> words_, int samples_, std::size_t maxTableSize_, std::ostream& out_):
+        words{std::move(words_)}, samples{samples_}, maxTableSize{maxTableSize_}, out{out_} {}
+
+    std::vector<BenchResult> runAll() {
+        hashFunctions();
+        probeGrid();
+        compactAndClear();
+        return results;
+    }
+
+private:
+    std::vector<std::string> words;
+    int samples;
+    std::size_t maxTableSize;
+    std::ostream& out;
+    std::vector<BenchResult> results;
+
+    void report(BenchResult r) {
+        out << "  " << std::left << std::setw(14) << r.benchmark << std::setw(22) << r.variant << std::right
+            << " M=" << std::setw(8) << r.tableSize
+            << "  load=" << std::fixed << std::setprecision(2) << r.loadFraction
+            << "  tomb=" << r.tombstoneFraction
+            << "  median=" << std::setprecision(1) << std::setw(10) << r.stats.medianNs << " ns/op"
+            << "  sd=" << std::setw(8) << r.stats.stddevNs
+            << "  probes/op=" << std::setprecision(2) << r.probesPerOp
+            << std::defaultfloat << std::setprecision(6) << "\n";
+        results.push_back(std::move(r));
+    }
+
+    void hashFunctions() {
+        out << "\nHash functions over " << words.size() << " corpus keys\n";
+        const std::size_t M = N_to_M_mapping.at(PROBE_GRID_N);
+        hashFunction("poly131_mod", M, [M](std::string_view k) { return polynomialModHash(k, 131, M); });
+        hashFunction("poly257_mod", M, [M](std::string_view k) { return polynomialModHash(k, 257, M - 1); });
+        hashFunction("poly131_64bit", M,
+                     [](std::string_view k) { return static_cast<std::size_t>(polynomialHash64(k, 131)); });
+        hashFunction("fnv1a_64", M, [](std::string_view k) { return static_cast<std::size_t>(fnv1aHash64(k)); });
+        hashFunction("siphash24", M, [](std::string_view k) {
+            return static_cast<std::size_t>(sipHash24(k, BENCH_KEY0, BENCH_KEY1));
+        });
+        hashFunction("fast_seeded", M,
+                     [](std::string_view k) { return static_cast<std::size_t>(fastHash64(k, BENCH_KEY0)); });
+
+        // The batch hash computes home, step and fingerprint together.
+        std::vector<std::string_view> views(words.begin(), words.end());
+        std::vector<std::size_t> home(words.size()), step(words.size());
+        std::vector<std::uint32_t> fingerprint(words.size());
+        std::vector<double> ns;
+        for (int s = 0; s < samples; s++)
+            ns.push_back(timeSample([] {}, [&] {
+                polynomialModHashBatch(views.data(), views.size(), M, M - 1, home.data(), step.data(),
+                                       fingerprint.data());
+                benchSink = home.back() + step.back();
+            }, words.size()));
+        report({"hash", "poly131_257_batch", M, 0, 0, words.size(), 0, summarize(ns)});
+    }
+
+    // Each hash is its own lambda type, so it inlines into the timed loop.
+    template <typename Hash>
+    void hashFunction(const std::string& name, std::size_t M, Hash hash) {
+        std::vector<double> ns;
+        for (int s = 0; s < samples; s++)
+            ns.push_back(timeSample([] {}, [&] {
+                std::size_t sink = 0;
+                for (const auto& key : words)
+                    sink += hash(key);
+                benchSink = sink;
+            }, words.size()));
+        report({"hash", name, M, 0, 0, words.size(), 0, summarize(ns)});
+    }
+
+    void probeGrid() {
+        const std::size_t M = N_to_M_mapping.at(PROBE_GRID_N);
+        const auto batch = std::max<std::size_t>(static_cast<std::size_t>(INSERT_BATCH_FRACTION * static_cast<double>(M)), 1);
+        const auto keys = twoWordKeys(words, 2 * M);
+        out << "\nmemberHelper and insert at M=" << M << "\n";
+
+        for (const auto probe : {HashTableDictionary::SINGLE, HashTableDictionary::DOUBLE}) {
+            const std::string probeName = probe == HashTableDictionary::SINGLE ? "single" : "double";
+            for (double load : LOAD_FRACTIONS) {
+                for (double tomb : TOMBSTONE_FRACTIONS) {
+                    if (load + tomb > MAX_OCCUPIED_FRACTION)
+                        continue;
+                    const auto active = static_cast<std::size_t>(load * static_cast<double>(M));
+                    const auto tombstones = static_cast<std::size_t>(tomb * static_cast<double>(M));
+                    HashTableDictionary table(M, probe);
+
+                    // Hits probe for the resident keys; misses for keys never
+                    // inserted. Neither changes the table, so one state serves
+                    // every sample.
+                    buildState(table, keys, M, load, tomb);
+                    const std::vector<std::string> hitKeys(keys.begin(), keys.begin() + active);
+                    const std::vector<std::string> missKeys(keys.begin() + M, keys.begin() + M + active);
+                    for (const auto& [variant, lookups] : {std::make_pair("member_hit", &hitKeys),
+                                                           std::make_pair("member_miss", &missKeys)}) {
+                        std::vector<double> ns;
+                        const auto probesBefore = table.counters().totalProbes;
+                        for (int s = 0; s < samples; s++)
+                            ns.push_back(timeSample([] {}, [&, lookups = lookups] {
+                                std::size_t sink = 0;
+                                for (const auto& key : *lookups)
+                                    sink += HashTableInternals::memberHelper(table, key);
+                                benchSink = sink;
+                            }, lookups->size()));
+                        const double probes = static_cast<double>(table.counters().totalProbes - probesBefore) /
+                                              static_cast<double>(lookups->size() * static_cast<std::size_t>(samples));
+                        report({variant, probeName, M, load, tomb, lookups->size(), probes, summarize(ns)});
+                    }
+
+                    // Inserts change the state, so each sample rebuilds it.
+                    std::vector<double> ns;
+                    std::int64_t probes = 0;
+                    std::int64_t probesBefore = 0;
+                    for (int s = 0; s < samples; s++) {
+                        ns.push_back(timeSample([&] {
+                            buildState(table, keys, M, load, tomb);
+                            probesBefore = table.counters().totalProbes;
+                        }, [&] {
+                            for (std::size_t i = 0; i < batch; i++)
+                                table.insert(keys[M + active + tombstones + i]);
+                        }, batch));
+                        probes += table.counters().totalProbes - probesBefore;
+                    }
+                    report({"insert", probeName, M, load, tomb, batch,
+                            static_cast<double>(probes) / static_cast<double>(batch * static_cast<std::size_t>(samples)),
+                            summarize(ns)});
+                }
+            }
+        }
+    }
+
+    void compactAndClear() {
+        out << "\ncompactTable and clear from load=" << COMPACT_LOAD_FRACTION
+                  << " tomb=" << COMPACT_TOMBSTONE_FRACTION << "\n";
+        for (const auto& [N, M] : N_to_M_mapping) {
+            const auto tableSize = static_cast<std::size_t>(M);
+            if (tableSize > maxTableSize)
+                break;
+            const auto keys = twoWordKeys(words, tableSize);
+            for (const auto probe : {HashTableDictionary::SINGLE, HashTableDictionary::DOUBLE}) {
+                const std::string probeName = probe == HashTableDictionary::SINGLE ? "single" : "double";
+                HashTableDictionary table(tableSize, probe);
+                auto setup = [&] {
+                    buildState(table, keys, tableSize, COMPACT_LOAD_FRACTION, COMPACT_TOMBSTONE_FRACTION);
+                };
+
+                std::vector<double> ns;
+                for (int s = 0; s < samples; s++)
+                    ns.push_back(timeSample(setup, [&] { HashTableInternals::compactTable(table); }, 1));
+                report({"compactTable", probeName, tableSize, COMPACT_LOAD_FRACTION, COMPACT_TOMBSTONE_FRACTION,
+                        1, 0, summarize(ns)});
+
+                ns.clear();
+                for (int s = 0; s < samples; s++)
+                    ns.push_back(timeSample(setup, [&] { table.clear(); }, 1));
+                report({"clear", probeName, tableSize, COMPACT_LOAD_FRACTION, COMPACT_TOMBSTONE_FRACTION,
+                        1, 0, summarize(ns)});
+            }
+        }
+    }
+};
+
+// ============================================================================
+// Main Program
+// ============================================================================
+
+int main(int argc, char* argv[]) {
+    if (argc > 4) {
+        std::cerr << "Usage: " << argv[0] << " [corpus] [samples] [max_table_size]" << std::endl;
+        return 1;
+    }
+    const std::string corpusPath = argc >= 2 ? argv[1] : DEFAULT_CORPUS;
+    int samples = DEFAULT_SAMPLES;
+    std::size_t maxTableSize = DEFAULT_MAX_TABLE_SIZE;
+    try {
+        if (argc >= 3)
+            samples = std::stoi(argv[2]);
+        if (argc >= 4)
+            maxTableSize = std::stoull(argv[3]);
+    } catch (const std::exception&) {
+        std::cerr << "Invalid samples or max_table_size" << std::endl;
+        return 1;
+    }
+    if (samples < 1) {
+        std::cerr << "samples must be at least 1" << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> words;
+    if (!loadCorpus(corpusPath, words))
+        return 1;
+    if (words.size() < 2) {
+        std::cerr << "The corpus needs at least two keys" << std::endl;
+        return 1;
+    }
+
+    // The table announces clear() and compaction on std::cout. Detach it for
+    // the run so none of that is formatted inside a timed region; reports go
+    // to the console through their own stream.
+    std::streambuf* console = std::cout.rdbuf();
+    std::ostream out(console);
+    out << "Corpus: " << corpusPath << " (" << words.size() << " keys), " << samples << " samples each\n";
+
+    std::cout.rdbuf(nullptr);
+    Microbenchmarks bench(std::move(words), samples, maxTableSize, out);
+    const auto results = bench.runAll();
+    std::cout.rdbuf(console);
+
+    namespace fs = std::filesystem;
+    fs::create_directories(fs::path(CSV_PATH).parent_path());
+    std::ofstream csv(CSV_PATH);
+    if (!csv) {
+        std::cerr << "Cannot open " << CSV_PATH << " for writing" << std::endl;
+        return 1;
+    }
+    csv << "benchmark,variant,table_size,load_fraction,tombstone_fraction,ops_per_sample,samples,"
+           "median_ns_per_op,mean_ns_per_op,stddev_ns_per_op,min_ns_per_op,probes_per_op\n";
+    for (const auto& r : results)
+        csv << r.benchmark << ',' << r.variant << ',' << r.tableSize << ',' << r.loadFraction << ','
+            << r.tombstoneFraction << ',' << r.opsPerSample << ',' << samples << ',' << r.stats.medianNs << ','
+            << r.stats.meanNs << ',' << r.stats.stddevNs << ',' << r.stats.minNs << ',' << r.probesPerOp << '\n';
+    std::cout << "\nResults written to: " << CSV_PATH << std::endl;
+    return 0;
+}
@@ -9,16 +9,17 @@
 
 enum class OpCode {
     Insert,     // I key
-    Erase  // E key (delete a key)
+    Erase,  // E key (delete a key)
+    Lookup  // L key (membership test)
   };
 
 struct Operation {
     OpCode tag;
     std::string key;
 
-    // Either of the two op_codes take a string argument.
+    // Every op_code takes a string argument.
     Operation(OpCode op_code, const std::string &k) : tag(op_code), key(k) {
-        assert(op_code == OpCode::Insert || op_code == OpCode::Erase);
+        assert(op_code == OpCode::Insert || op_code == OpCode::Erase || op_code == OpCode::Lookup);
     }
 
     void print() const {
@@ -29,6 +30,9 @@ struct Operation {
             case OpCode::Erase:
                 std::cout << "E " << key << std::endl;
                 break;
+            case OpCode::Lookup:
+                std::cout << "L " << key << std::endl;
+                break;
             default:
                 std::cout << "Unknown operation: " << static_cast<int>(tag) << std::endl;
         }
@@ -37,4 +41,5 @@ struct Operation {
     // Identify the instance
     [[nodiscard]] bool isInsert()     const { return tag == OpCode::Insert; }
     [[nodiscard]] bool isFindMin()    const { return tag == OpCode::Erase; }
+    [[nodiscard]] bool isLookup()     const { return tag == OpCode::Lookup; }
 };
@@ -0,0 +1,87 @@
+//
+// TableSizes.cpp
+//
+
+#include "TableSizes.hpp"
+#include <cassert>
+#include <cmath>
+
+namespace {
+std::uint64_t mulMod(std::uint64_t a, std::uint64_t b, std::uint64_t m) {
+    return static_cast<std::uint64_t>(static_cast<unsigned __int128>(a) * b % m);
+}
+
+std::uint64_t powMod(std::uint64_t base, std::uint64_t exponent, std::uint64_t m) {
+    std::uint64_t result = 1;
+    base %= m;
+    while (exponent > 0) {
+        if (exponent & 1)
+            result = mulMod(result, base, m);
+        base = mulMod(base, base, m);
+        exponent >>= 1;
+    }
+    return result;
+}
+}
+
+bool isPrime(std::uint64_t n) {
+    // These twelve witnesses decide primality for all n < 3.18e23, which
+    // covers every 64-bit n.
+    constexpr std::uint64_t witnesses[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+    if (n < 2)
+        return false;
+    for (std::uint64_t p : witnesses) {
+        if (n % p == 0)
+            return n == p;
+    }
+
+    std::uint64_t d = n - 1;
+    int s = 0;
+    while ((d & 1) == 0) {
+        d >>= 1;
+        s++;
+    }
+    for (std::uint64_t a : witnesses) {
+        std::uint64_t x = powMod(a, d, n);
+        if (x == 1 || x == n - 1)
+            continue;
+        bool composite = true;
+        for (int r = 1; r < s && composite; r++) {
+            x = mulMod(x, x, n);
+            composite = x != n - 1;
+        }
+        if (composite)
+            return false;
+    }
+    return true;
+}
+
+std::uint64_t nextPrime(std::uint64_t n) {
+    if (n <= 2)
+        return 2;
+    n |= 1;
+    while (!isPrime(n))
+        n += 2;
+    return n;
+}
+
+std::uint64_t nextPowerOfTwo(std::uint64_t n) {
+    std::uint64_t p = 1;
+    while (p < n)
+        p <<= 1;
+    return p;
+}
+
+std::size_t tableSizeForLoad(std::size_t N, double loadFactor, TableRounding rounding) {
+    assert(loadFactor > 0.0 && loadFactor <= 1.0);
+    const auto minimum = static_cast<std::uint64_t>(std::ceil(static_cast<double>(N) / loadFactor));
+    return rounding == TableRounding::PRIME ? nextPrime(minimum) : nextPowerOfTwo(minimum);
+}
+
+std::size_t tableSizeForN(std::size_t N) {
+    for (const auto& [standardN, M] : N_to_M_mapping) {
+        if (static_cast<std::size_t>(standardN) == N)
+            return static_cast<std::size_t>(M);
+    }
+    return tableSizeForLoad(N, DEFAULT_LOAD_FACTOR);
+}
@@ -0,0 +1,52 @@
+//
+// TableSizes.hpp - Table size M for a trace capacity N and a target load factor.
+//
+
+#ifndef HASHTABLESOPENADDRESSING_TABLESIZES_HPP
+#define HASHTABLESOPENADDRESSING_TABLESIZES_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+// The sizes of Section 4.4: a prime M for each N = 2^10 .. 2^20, all at a
+// load factor N / M of about 0.8. These are the traces' standard capacities.
+inline const std::map<int, int> N_to_M_mapping = {
+    {1024,    1279},
+    {2048,    2551},
+    {4096,    5101},
+    {8192,    10273},
+    {16384,   20479},
+    {32768,   40849},
+    {65536,   81931},
+    {131072,  163861},
+    {262144,  327739},
+    {524288,  655243},
+    {1048576, 1310809}
+};
+
+// Load factor of the Section 4.4 sizes, used for N outside N_to_M_mapping.
+constexpr double DEFAULT_LOAD_FACTOR = 0.8;
+
+// Prime sizes suit the modulo probing of HashTableDictionary; power-of-two
+// sizes are for tables that reduce a hash with a mask.
+enum class TableRounding { PRIME, POWER_OF_TWO };
+
+// Deterministic Miller-Rabin, exact for every 64-bit n.
+bool isPrime(std::uint64_t n);
+
+// Smallest prime >= n.
+std::uint64_t nextPrime(std::uint64_t n);
+
+// Smallest power of two >= n.
+std::uint64_t nextPowerOfTwo(std::uint64_t n);
+
+// Smallest M of the given rounding with N / M <= loadFactor, 0 < loadFactor <= 1.
+std::size_t tableSizeForLoad(std::size_t N, double loadFactor,
+                             TableRounding rounding = TableRounding::PRIME);
+
+// The Section 4.4 size when N is a standard capacity; otherwise
+// tableSizeForLoad(N, DEFAULT_LOAD_FACTOR).
+std::size_t tableSizeForN(std::size_t N);
+
+#endif //HASHTABLESOPENADDRESSING_TABLESIZES_HPP
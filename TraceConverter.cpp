@@ -0,0 +1,46 @@
+/**
+ * Trace Converter
+ *
+ * Converts a text trace ("<profile> <N> <seed>" header, then I/E/L lines) into
+ * the .btrace binary format described in BinaryTrace.hpp.
+ */
+
+#include <iostream>
+#include <string>
+#include <filesystem>
+
+#include "BinaryTrace.hpp"
+#include "harness/MappedTrace.h"
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " <input.trace> [output.btrace]" << std::endl;
+        return 1;
+    }
+
+    const std::string inputPath = argv[1];
+    std::string outputPath;
+    if (argc == 3) {
+        outputPath = argv[2];
+    } else {
+        outputPath = std::filesystem::path(inputPath).replace_extension(".btrace").string();
+    }
+
+    RunMetaData meta;
+    OperationStream operations;
+    if (!load_trace_mmap(inputPath, meta, operations))
+        return 1;
+
+    BinaryTraceWriter writer(meta.profile, static_cast<std::uint64_t>(meta.N), meta.seed);
+    for (const auto op : operations)
+        writer.add(opcodeLetter(op.tag), op.key);
+    if (!writer.write(outputPath))
+        return 1;
+
+    const auto inBytes = std::filesystem::file_size(inputPath);
+    const auto outBytes = std::filesystem::file_size(outputPath);
+    std::cout << "Wrote " << outputPath << ": " << writer.numOperations() << " operations, "
+              << writer.numKeys() << " distinct keys, " << inBytes << " -> " << outBytes << " bytes ("
+              << static_cast<double>(inBytes) / static_cast<double>(outBytes) << "x smaller)" << std::endl;
+    return 0;
+}
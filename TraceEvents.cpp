@@ -0,0 +1,158 @@
+//
+// TraceEvents.cpp
+//
+
+#include "TraceEvents.hpp"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    std::int64_t startNs;
+    std::int64_t durationNs;
+    const char* argNames[2];
+    std::int64_t args[2];
+};
+
+struct ThreadEvents {
+    std::size_t tid = 0;
+    std::string name;
+    std::vector<TraceEvent> events;
+    std::size_t dropped = 0;
+};
+
+std::atomic<bool> recording{false};
+std::size_t eventsPerThreadLimit = 0;
+std::chrono::steady_clock::time_point epoch;
+
+// Buffers outlive their threads, so spans of joined workers are still written.
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadEvents>> registry;
+
+ThreadEvents& threadEvents() {
+    thread_local ThreadEvents* mine = nullptr;
+    if (mine == nullptr) {
+        auto buffer = std::make_unique<ThreadEvents>();
+        buffer->events.reserve(eventsPerThreadLimit);
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffer->tid = registry.size() + 1;
+        mine = buffer.get();
+        registry.push_back(std::move(buffer));
+    }
+    return *mine;
+}
+
+std::int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+std::string jsonString(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        if (static_cast<unsigned char>(c) >= 0x20)
+            out += c;
+    }
+    return out + "\"";
+}
+}
+
+void enableTraceEvents(std::size_t eventsPerThread) {
+    eventsPerThreadLimit = eventsPerThread;
+    epoch = std::chrono::steady_clock::now();
+    recording.store(true, std::memory_order_release);
+}
+
+bool traceEventsEnabled() {
+    return recording.load(std::memory_order_acquire);
+}
+
+void nameTraceThread(const std::string& name) {
+    if (traceEventsEnabled())
+        threadEvents().name = name;
+}
+
+TraceSpan::TraceSpan(const char* name_, const char* category_):
+    name{name_}, category{category_} {
+    if (traceEventsEnabled())
+        startNs = nowNs();
+}
+
+TraceSpan::TraceSpan(const char* name_, const char* category_, const char* argName, std::int64_t arg):
+    TraceSpan(name_, category_) {
+    setArg(argName, arg);
+}
+
+TraceSpan::TraceSpan(const char* name_, const char* category_, const char* argName, std::int64_t arg,
+                     const char* argName2, std::int64_t arg2):
+    TraceSpan(name_, category_) {
+    setArg(argName, arg);
+    setArg(argName2, arg2);
+}
+
+void TraceSpan::setArg(const char* argName, std::int64_t arg) {
+    const int slot = argNames[0] == nullptr || argNames[0] == argName ? 0 : 1;
+    argNames[slot] = argName;
+    args[slot] = arg;
+}
+
+TraceSpan::~TraceSpan() {
+    if (startNs < 0)
+        return;
+    const std::int64_t endNs = nowNs();
+    ThreadEvents& buffer = threadEvents();
+    if (buffer.events.size() == buffer.events.capacity()) {
+        buffer.dropped++;
+        return;
+    }
+    buffer.events.push_back({name, category, startNs, endNs - startNs, {argNames[0], argNames[1]}, {args[0], args[1]}});
+}
+
+bool writeTraceEvents(const std::string& path) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Cannot open " << path << " for the trace events" << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::size_t spans = 0, dropped = 0;
+    const char* separator = "\n";
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    out << std::fixed << std::setprecision(3);
+    for (const auto& thread : registry) {
+        if (!thread->name.empty()) {
+            out << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->tid
+                << ",\"args\":{\"name\":" << jsonString(thread->name) << "}}";
+            separator = ",\n";
+        }
+        for (const auto& e : thread->events) {
+            // Timestamps are in microseconds.
+            out << separator << "{\"name\":" << jsonString(e.name) << ",\"cat\":" << jsonString(e.category)
+                << ",\"ph\":\"X\",\"ts\":" << static_cast<double>(e.startNs) / 1e3
+                << ",\"dur\":" << static_cast<double>(e.durationNs) / 1e3
+                << ",\"pid\":1,\"tid\":" << thread->tid << ",\"args\":{";
+            for (int a = 0; a < 2 && e.argNames[a] != nullptr; a++)
+                out << (a == 0 ? "" : ",") << jsonString(e.argNames[a]) << ':' << e.args[a];
+            out << "}}";
+            separator = ",\n";
+        }
+        spans += thread->events.size();
+        dropped += thread->dropped;
+    }
+    out << "\n]}\n";
+
+    if (dropped != 0)
+        std::cerr << "WARNING: " << dropped << " trace events dropped; per-thread buffers were full" << std::endl;
+    std::cout << "Trace events (" << spans << " spans) written to: " << path << std::endl;
+    return static_cast<bool>(out);
+}
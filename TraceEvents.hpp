@@ -0,0 +1,54 @@
+//
+// TraceEvents.hpp - Chrome trace-event spans of harness phases and table events.
+//
+// Spans go into a buffer per thread, allocated at full size on the thread's
+// first span, so recording one is two clock reads and a store; once a buffer
+// is full further spans are counted and dropped. writeTraceEvents() emits the
+// Chrome trace-event JSON format (complete "X" events), which Perfetto and
+// chrome://tracing open. Nothing is recorded until enableTraceEvents().
+//
+
+#ifndef HASHTABLESOPENADDRESSING_TRACEEVENTS_HPP
+#define HASHTABLESOPENADDRESSING_TRACEEVENTS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Starts recording, with room for eventsPerThread spans on each thread.
+void enableTraceEvents(std::size_t eventsPerThread = 1 << 16);
+[[nodiscard]] bool traceEventsEnabled();
+
+// Labels the calling thread in the output, e.g. "worker 1".
+void nameTraceThread(const std::string& name);
+
+// Records a span from construction to destruction, with up to two integer
+// arguments. The name, category and argument names are stored as pointers,
+// so they must be string literals.
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, const char* category = "harness");
+    TraceSpan(const char* name, const char* category, const char* argName, std::int64_t arg);
+    TraceSpan(const char* name, const char* category, const char* argName, std::int64_t arg,
+              const char* argName2, std::int64_t arg2);
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    // Sets an argument known only once the span has run, e.g. a loaded trace's N.
+    void setArg(const char* argName, std::int64_t arg);
+
+private:
+    const char* name;
+    const char* category;
+    const char* argNames[2] = {nullptr, nullptr};
+    std::int64_t args[2] = {0, 0};
+    std::int64_t startNs = -1;  // -1 while recording is disabled
+};
+
+// Writes every span recorded so far. Call it after the recording threads
+// have finished; spans recorded in forked children are not included.
+bool writeTraceEvents(const std::string& path);
+
+#endif //HASHTABLESOPENADDRESSING_TRACEEVENTS_HPP
@@ -0,0 +1,25 @@
+# Writes OUTPUT, a header defining HARNESS_GIT_REVISION as the short hash of
+# HEAD in SOURCE_DIR ("unknown" outside a git checkout). Run at build time
+# with cmake -P; the file is only rewritten when the revision changes, so an
+# unchanged HEAD does not trigger a rebuild.
+
+set(revision "unknown")
+if (GIT_EXECUTABLE)
+    execute_process(COMMAND ${GIT_EXECUTABLE} rev-parse --short HEAD
+            WORKING_DIRECTORY ${SOURCE_DIR}
+            OUTPUT_VARIABLE git_revision
+            OUTPUT_STRIP_TRAILING_WHITESPACE
+            ERROR_QUIET
+            RESULT_VARIABLE git_result)
+    if (git_result EQUAL 0)
+        set(revision "${git_revision}")
+    endif ()
+endif ()
+
+set(contents "#pragma once\n#define HARNESS_GIT_REVISION \"${revision}\"\n")
+if (EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} existing)
+endif ()
+if (NOT existing STREQUAL contents)
+    file(WRITE ${OUTPUT} "${contents}")
+endif ()
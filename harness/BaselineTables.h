@@ -0,0 +1,149 @@
+//
+// BaselineTables.h - Reference set implementations for the harness
+//
+// Each baseline offers the interface run_trace_ops() replays against
+// (insert / remove / clear / csvStats / counters), and csvStats() fills the same columns
+// as HashTableDictionary::csvStatsHeader(), leaving probing and compaction
+// columns that do not apply empty, so baseline rows line up in the CSV.
+//
+
+#pragma once
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "../HashTableDictionary.hpp"
+
+namespace baseline_detail {
+
+// table_size,active,available,tombstones,total_probes,table_inserts,
+// table_deletes,lookups,full_scans,compactions,max_in_table,available_pct,
+// load_factor_pct,eff_load_factor_pct,tombstones_pct,average_probes,
+// probe_type,compaction_state
+inline std::string csv_stats(std::size_t slots, std::size_t active, std::int64_t inserts, std::int64_t deletes,
+                             std::int64_t lookups, std::size_t max_in_table, const char *kind) {
+    const int load_pct = slots != 0 ? static_cast<int>(static_cast<double>(active) / static_cast<double>(slots) * 100) : 0;
+    return std::to_string(slots) + "," + std::to_string(active) + ",,0,," +
+           std::to_string(inserts) + "," + std::to_string(deletes) + "," + std::to_string(lookups) + ",0,0," +
+           std::to_string(max_in_table) + ",," + std::to_string(load_pct) + "," + std::to_string(load_pct) +
+           ",0,," + kind + ",n/a";
+}
+
+} // namespace baseline_detail
+
+// ============================================================================
+// std::unordered_set<std::string> - separate chaining, one node per key
+// ============================================================================
+class UnorderedSetTable {
+public:
+    // Starts with at least `buckets` buckets, like a table of size M.
+    explicit UnorderedSetTable(std::size_t buckets) : buckets_(buckets) { set_.reserve(buckets_); }
+
+    bool insert(std::string_view key) {
+        const bool inserted = set_.emplace(key).second;
+        if (inserted) {
+            ++inserts_;
+            max_in_table_ = std::max(max_in_table_, set_.size());
+        }
+        return inserted;
+    }
+
+    // std::unordered_set has no heterogeneous lookup before C++20, so keys
+    // are copied into a reused string that stops allocating once it has
+    // grown to the longest key.
+    bool remove(std::string_view key) {
+        const bool erased = set_.erase(scratch_.assign(key)) != 0;
+        if (erased)
+            ++deletes_;
+        return erased;
+    }
+
+    bool member(std::string_view key) {
+        ++lookups_;
+        return set_.count(scratch_.assign(key)) != 0;
+    }
+
+    void clear() {
+        set_ = std::unordered_set<std::string>();
+        set_.reserve(buckets_);
+        inserts_ = deletes_ = lookups_ = 0;
+        max_in_table_ = 0;
+    }
+
+    std::string csvStats() {
+        return baseline_detail::csv_stats(set_.bucket_count(), set_.size(), inserts_, deletes_, lookups_,
+                                          max_in_table_, "chaining");
+    }
+
+    HashTableDictionary::Counters counters() const {
+        return {static_cast<std::int64_t>(set_.bucket_count()), static_cast<std::int64_t>(set_.size()), 0, 0,
+                inserts_, deletes_, lookups_, 0, 0};
+    }
+
+private:
+    std::size_t buckets_;
+    std::unordered_set<std::string> set_;
+    std::string scratch_;
+    std::int64_t inserts_ = 0;
+    std::int64_t deletes_ = 0;
+    std::int64_t lookups_ = 0;
+    std::size_t max_in_table_ = 0;
+};
+
+// ============================================================================
+// Sorted std::vector<std::string> - binary search, O(n) insert and erase
+// ============================================================================
+class SortedVectorTable {
+public:
+    explicit SortedVectorTable(std::size_t capacity) : capacity_(capacity) { keys_.reserve(capacity_); }
+
+    bool insert(std::string_view key) {
+        const auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+        if (it != keys_.end() && *it == key)
+            return false;
+        keys_.emplace(it, key);
+        ++inserts_;
+        max_in_table_ = std::max(max_in_table_, keys_.size());
+        return true;
+    }
+
+    bool remove(std::string_view key) {
+        const auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+        if (it == keys_.end() || *it != key)
+            return false;
+        keys_.erase(it);
+        ++deletes_;
+        return true;
+    }
+
+    bool member(std::string_view key) {
+        ++lookups_;
+        return std::binary_search(keys_.begin(), keys_.end(), key);
+    }
+
+    void clear() {
+        keys_.clear();
+        inserts_ = deletes_ = lookups_ = 0;
+        max_in_table_ = 0;
+    }
+
+    std::string csvStats() {
+        return baseline_detail::csv_stats(keys_.capacity(), keys_.size(), inserts_, deletes_, lookups_,
+                                          max_in_table_, "binary_search");
+    }
+
+    HashTableDictionary::Counters counters() const {
+        return {static_cast<std::int64_t>(keys_.capacity()), static_cast<std::int64_t>(keys_.size()), 0, 0,
+                inserts_, deletes_, lookups_, 0, 0};
+    }
+
+private:
+    std::size_t capacity_;
+    std::vector<std::string> keys_;
+    std::int64_t inserts_ = 0;
+    std::int64_t deletes_ = 0;
+    std::int64_t lookups_ = 0;
+    std::size_t max_in_table_ = 0;
+};
@@ -0,0 +1,89 @@
+//
+// BenchmarkScheduler.h - Worker pool for independent benchmark jobs
+//
+// Each (trace, implementation, configuration) run is a job. Jobs are queued in
+// a fixed order and workers claim them from a shared counter; a job writes its
+// result into the slot for its own index, so the output order never depends
+// on which worker finished first. With concurrency > 1 every worker is pinned
+// to its own core of the process's cpuset so concurrent timings do not
+// migrate between CPUs.
+//
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "CpuAffinity.h"
+#include "../TraceEvents.hpp"
+
+class BenchmarkScheduler {
+public:
+    // concurrency 0 means one worker per CPU the process may run on.
+    explicit BenchmarkScheduler(unsigned concurrency = 1, bool pin_workers = true)
+        : concurrency_(concurrency != 0 ? concurrency : cpu_count(current_cpus())),
+          pin_workers_(pin_workers) {}
+
+    // Returns the job's index; jobs run in any order but keep their index.
+    std::size_t add(std::function<void()> job) {
+        jobs_.push_back(std::move(job));
+        return jobs_.size() - 1;
+    }
+
+    // Runs every queued job and blocks until all have finished.
+    void run() {
+        const unsigned workers = static_cast<unsigned>(std::min<std::size_t>(concurrency_, jobs_.size()));
+        std::atomic<std::size_t> next{0};
+        // Read once here, after a prefetcher has taken its core out of the
+        // mask, and recorded so helper threads leave their worker's core.
+        const cpu_set_t allowed = current_cpus();
+        record_helper_cpus(allowed);
+        auto work = [this, &next, workers, &allowed](unsigned worker, bool pin) {
+            if (pin)
+                pin_to_core(worker, allowed);
+            if (workers > 1)
+                nameTraceThread("worker " + std::to_string(worker));
+            for (std::size_t j = next++; j < jobs_.size(); j = next++)
+                jobs_[j]();
+        };
+
+        if (workers <= 1) {
+            work(0, false);
+        } else {
+            std::cout << "Running " << jobs_.size() << " jobs on " << workers << " workers\n";
+            std::vector<std::thread> pool;
+            for (unsigned w = 0; w < workers; ++w)
+                pool.emplace_back(work, w, pin_workers_);
+            for (auto &t: pool)
+                t.join();
+        }
+        jobs_.clear();
+    }
+
+    std::size_t size() const { return jobs_.size(); }
+    unsigned concurrency() const { return concurrency_; }
+
+private:
+    // Pins the calling worker thread to the worker-th CPU in `allowed`.
+    static void pin_to_core(unsigned worker, const cpu_set_t &allowed) {
+        const int core = nth_cpu(allowed, worker);
+        if (core < 0)
+            return;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+            std::cerr << "WARNING: could not pin worker " << worker << " to core " << core << "\n";
+    }
+
+    unsigned concurrency_;
+    bool pin_workers_;
+    std::vector<std::function<void()>> jobs_;
+};
@@ -0,0 +1,73 @@
+//
+// CpuAffinity.h - The CPUs this process may run on
+//
+// The process's cpuset can be smaller than the machine (taskset, containers),
+// so worker counts and pinning come from sched_getaffinity rather than
+// hardware_concurrency, and CPU n of a pool means the n-th CPU in that mask.
+//
+// A thread inherits the mask of the thread that starts it. Helper threads
+// (the streaming reader, the parallel parser) are started from timing workers
+// pinned to a single CPU, so they re-widen themselves to the helper mask the
+// scheduler records before it pins anyone.
+//
+
+#pragma once
+#include <mutex>
+
+#include <pthread.h>
+#include <sched.h>
+
+namespace cpu_affinity_detail {
+inline std::mutex helper_mutex;
+inline cpu_set_t helper_cpus;
+inline bool helper_cpus_recorded = false;
+} // namespace cpu_affinity_detail
+
+// The calling thread's mask; every CPU when it cannot be read.
+inline cpu_set_t current_cpus() {
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+        CPU_ZERO(&set);
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            CPU_SET(cpu, &set);
+    }
+    return set;
+}
+
+inline unsigned cpu_count(const cpu_set_t &set) {
+    const int count = CPU_COUNT(&set);
+    return count > 0 ? static_cast<unsigned>(count) : 1u;
+}
+
+// The n-th CPU in `set`, wrapping around; -1 for an empty set.
+inline int nth_cpu(const cpu_set_t &set, unsigned n) {
+    n %= cpu_count(set);
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &set) && n-- == 0)
+            return cpu;
+    }
+    return -1;
+}
+
+// Records `set` as the mask helper threads run on.
+inline void record_helper_cpus(const cpu_set_t &set) {
+    std::lock_guard<std::mutex> lock(cpu_affinity_detail::helper_mutex);
+    cpu_affinity_detail::helper_cpus = set;
+    cpu_affinity_detail::helper_cpus_recorded = true;
+}
+
+// The recorded helper mask, or the calling thread's own before one is recorded.
+inline cpu_set_t helper_cpus() {
+    {
+        std::lock_guard<std::mutex> lock(cpu_affinity_detail::helper_mutex);
+        if (cpu_affinity_detail::helper_cpus_recorded)
+            return cpu_affinity_detail::helper_cpus;
+    }
+    return current_cpus();
+}
+
+// Moves the calling helper thread onto the helper mask.
+inline void run_on_helper_cpus() {
+    const cpu_set_t set = helper_cpus();
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
@@ -0,0 +1,94 @@
+//
+// LatencyHistogram.h - HDR-style histogram of per-operation latencies
+//
+// Log-linear buckets: values below 2^SUB_BITS nanoseconds are counted
+// exactly, and every power-of-two range above that is split into
+// 2^(SUB_BITS - 1) equal buckets, so any recorded value is reported within
+// 1/64 (~1.6%) of itself. The whole range of a 64-bit value fits in ~3800
+// counters, and recording is a bit scan and an increment.
+//
+
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Percentiles of one operation type, in nanoseconds. count == 0 means no
+// latencies were recorded.
+struct LatencySummary {
+    std::uint64_t count = 0;
+    std::uint64_t p50_ns = 0;
+    std::uint64_t p99_ns = 0;
+    std::uint64_t p999_ns = 0;
+    std::uint64_t max_ns = 0;
+};
+
+class LatencyHistogram {
+public:
+    static constexpr unsigned SUB_BITS = 7;
+    static constexpr std::uint64_t SUB_COUNT = std::uint64_t{1} << SUB_BITS;
+    static constexpr std::uint64_t HALF_COUNT = SUB_COUNT / 2;
+
+    LatencyHistogram() : counts_(bucket_index(~std::uint64_t{0}) + 1, 0) {}
+
+    void record(std::uint64_t ns) {
+        ++counts_[bucket_index(ns)];
+        ++total_;
+        max_ = std::max(max_, ns);
+    }
+
+    void clear() {
+        std::fill(counts_.begin(), counts_.end(), 0);
+        total_ = 0;
+        max_ = 0;
+    }
+
+    // Smallest bucket bound with at least fraction q of the values at or
+    // below it, clamped to the largest value seen.
+    std::uint64_t value_at_quantile(double q) const {
+        if (total_ == 0)
+            return 0;
+        const auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(q * static_cast<double>(total_) + 0.5));
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < counts_.size(); ++i) {
+            seen += counts_[i];
+            if (seen >= rank)
+                return std::min(bucket_upper_bound(i), max_);
+        }
+        return max_;
+    }
+
+    LatencySummary summary() const {
+        LatencySummary s;
+        s.count = total_;
+        s.p50_ns = value_at_quantile(0.50);
+        s.p99_ns = value_at_quantile(0.99);
+        s.p999_ns = value_at_quantile(0.999);
+        s.max_ns = max_;
+        return s;
+    }
+
+    std::uint64_t count() const { return total_; }
+    std::uint64_t max() const { return max_; }
+
+private:
+    static std::size_t bucket_index(std::uint64_t v) {
+        if (v < SUB_COUNT)
+            return static_cast<std::size_t>(v);
+        const unsigned msb = 63u - static_cast<unsigned>(__builtin_clzll(v));
+        const unsigned shift = msb - SUB_BITS + 1;  // top SUB_BITS bits are kept
+        return static_cast<std::size_t>(SUB_COUNT + (shift - 1) * HALF_COUNT + ((v >> shift) - HALF_COUNT));
+    }
+
+    static std::uint64_t bucket_upper_bound(std::size_t index) {
+        if (index < SUB_COUNT)
+            return index;
+        const std::uint64_t shift = (index - SUB_COUNT) / HALF_COUNT + 1;
+        const std::uint64_t top = (index - SUB_COUNT) % HALF_COUNT + HALF_COUNT;
+        return ((top + 1) << shift) - 1;
+    }
+
+    std::vector<std::uint64_t> counts_;
+    std::uint64_t total_ = 0;
+    std::uint64_t max_ = 0;
+};
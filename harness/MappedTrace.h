@@ -0,0 +1,332 @@
+//
+// MappedTrace.h - mmap-based trace loading for the LRU harness
+//
+// The trace file is mmap'ed read-only and decoded into an OperationStream, so
+// loading allocates nothing per operation and the mapping is released once
+// the distinct keys have been copied into the stream's pool. Text traces are
+// split at line boundaries into one chunk per thread; each thread scans its
+// chunk with memchr into its own stream and the chunks are merged in file
+// order. Binary .btrace files need only their op stream decoded.
+//
+
+#pragma once
+#include <string>
+#include <string_view>
+#include <sstream>
+#include <vector>
+#include <thread>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "CpuAffinity.h"
+#include "Operation.h"
+#include "OperationStream.h"
+#include "RunMetaData.h"
+#include "../BinaryTrace.hpp"
+
+// ============================================================================
+// Read-only memory mapping of a whole file
+// ============================================================================
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept { swap(other); }
+    MappedFile &operator=(MappedFile &&other) noexcept {
+        swap(other);
+        return *this;
+    }
+    ~MappedFile() { unmap(); }
+
+    bool map(const std::string &path) {
+        unmap();
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void *p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED)
+            return false;
+        ::madvise(p, static_cast<std::size_t>(st.st_size), MADV_SEQUENTIAL);
+        data_ = static_cast<const char *>(p);
+        size_ = static_cast<std::size_t>(st.st_size);
+        return true;
+    }
+
+    void unmap() {
+        if (data_ != nullptr)
+            ::munmap(const_cast<char *>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    const char *data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    void swap(MappedFile &other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+    }
+
+    const char *data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+namespace mapped_trace_detail {
+
+inline bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+struct ParseStatus {
+    std::size_t lines = 0;       // newline-terminated lines scanned
+    std::size_t error_line = 0;  // 1-based line within the chunk, 0 = ok
+    std::string error;
+};
+
+struct ChunkResult : ParseStatus {
+    OperationStream operations;
+};
+
+// Parses whole lines in [begin, end), calling sink(tag, key) per operation.
+// The key points into [begin, end) unless its words had to be re-joined with
+// a single space, in which case it is only valid during the call.
+template<typename Sink>
+void parse_lines(const char *begin, const char *end, ParseStatus &out, Sink &&sink) {
+    const char *line = begin;
+    while (line < end) {
+        const char *nl = static_cast<const char *>(std::memchr(line, '\n', static_cast<std::size_t>(end - line)));
+        const char *line_end = nl != nullptr ? nl : end;
+        ++out.lines;
+
+        const char *p = line;
+        while (p < line_end && is_space(*p)) ++p;
+        if (p == line_end || *p == '#') {  // blank and comment lines
+            line = line_end + 1;
+            continue;
+        }
+
+        // Opcode token
+        const char *op = p;
+        while (p < line_end && !is_space(*p)) ++p;
+        const std::string_view opcode_str(op, static_cast<std::size_t>(p - op));
+
+        OpCode tag;
+        if (opcode_str.size() != 1 || !opcodeFromLetter(opcode_str[0], tag)) {
+            out.error_line = out.lines;
+            out.error = "Unknown opcode '" + std::string(opcode_str) + "'";
+            return;
+        }
+
+        // IMPORTANT: Keys consist of TWO words separated by space
+        while (p < line_end && is_space(*p)) ++p;
+        const char *w1 = p;
+        while (p < line_end && !is_space(*p)) ++p;
+        const char *w1_end = p;
+        while (p < line_end && is_space(*p)) ++p;
+        const char *w2 = p;
+        while (p < line_end && !is_space(*p)) ++p;
+        const char *w2_end = p;
+
+        if (w1 == w1_end || w2 == w2_end) {
+            out.error_line = out.lines;
+            out.error = std::string(tag == OpCode::Insert ? "Insert" : tag == OpCode::Erase ? "Erase" : "Lookup") +
+                        " missing key (needs two words)";
+            return;
+        }
+
+        if (w2 == w1_end + 1 && *w1_end == ' ') {
+            sink(tag, std::string_view(w1, static_cast<std::size_t>(w2_end - w1)));
+        } else {
+            // Normalize the separator to a single space.
+            sink(tag, std::string_view(std::string(w1, w1_end) + " " + std::string(w2, w2_end)));
+        }
+        line = line_end + 1;
+    }
+}
+
+inline void parse_chunk(const char *begin, const char *end, ChunkResult &out) {
+    parse_lines(begin, end, out, [&out](OpCode tag, std::string_view key) {
+        out.operations.push_back(tag, key);
+    });
+}
+
+// Parses "<profile> <N> <seed>"; reports errors like the loaders do.
+inline bool parse_header(const std::string &header, RunMetaData &runMeta) {
+    const auto first = header.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos || header[first] == '#') {
+        std::cerr << "ERROR: Invalid header line\n";
+        return false;
+    }
+
+    std::istringstream hdr(header);
+    std::string profile;
+    int N = 0;
+    int seed = 0;
+    if (!(hdr >> profile >> N >> seed)) {
+        std::cerr << "ERROR: Cannot parse header: " << header << "\n";
+        return false;
+    }
+    runMeta.profile = profile;
+    runMeta.N = N;
+    runMeta.seed = seed;
+    return true;
+}
+
+} // namespace mapped_trace_detail
+
+// ============================================================================
+// Load text trace file via mmap
+// ============================================================================
+// Header: <profile> <N> <seed>. Then "I w1 w2" / "E w1 w2" / "L w1 w2" lines; blank
+// lines and lines starting with '#' are skipped.
+inline bool load_trace_mmap(const std::string &path,
+                            RunMetaData &runMeta,
+                            OperationStream &out,
+                            unsigned num_threads = 0) {
+    using namespace mapped_trace_detail;
+    out.clear();
+
+    MappedFile file;
+    if (!file.map(path)) {
+        std::cerr << "ERROR: Cannot map trace file: " << path << "\n";
+        return false;
+    }
+    const char *data = file.data();
+    const char *end = data + file.size();
+
+    // ========================================================================
+    // Header: <profile> <N> <seed>
+    // ========================================================================
+    const char *nl = static_cast<const char *>(std::memchr(data, '\n', file.size()));
+    const char *header_end = nl != nullptr ? nl : end;
+    if (!parse_header(std::string(data, header_end), runMeta))
+        return false;
+
+    std::cout << "Loaded trace: " << runMeta.profile << " N=" << runMeta.N << " seed=" << runMeta.seed << "\n";
+
+    // ========================================================================
+    // Split the body at newlines, one chunk per thread
+    // ========================================================================
+    const char *body = nl != nullptr ? nl + 1 : end;
+    if (num_threads == 0)
+        num_threads = cpu_count(helper_cpus());
+    const std::size_t body_size = static_cast<std::size_t>(end - body);
+    num_threads = static_cast<unsigned>(std::min<std::size_t>(num_threads, body_size / (1 << 20) + 1));
+
+    std::vector<const char *> bounds{body};
+    for (unsigned t = 1; t < num_threads; ++t) {
+        const char *target = body + body_size * t / num_threads;
+        if (target <= bounds.back())
+            continue;
+        const char *split = static_cast<const char *>(std::memchr(target, '\n', static_cast<std::size_t>(end - target)));
+        if (split == nullptr)
+            break;
+        bounds.push_back(split + 1);
+    }
+    bounds.push_back(end);
+
+    std::vector<ChunkResult> chunks(bounds.size() - 1);
+    std::vector<std::thread> workers;
+    for (std::size_t c = 1; c < chunks.size(); ++c) {
+        workers.emplace_back([&bounds, &chunks, c] {
+            run_on_helper_cpus();
+            parse_chunk(bounds[c], bounds[c + 1], chunks[c]);
+        });
+    }
+    parse_chunk(bounds[0], bounds[1], chunks[0]);
+    for (auto &w: workers)
+        w.join();
+
+    // ========================================================================
+    // Merge in file order
+    // ========================================================================
+    std::size_t total = 0;
+    std::size_t line_base = 1;  // header is line 1
+    for (auto &chunk: chunks) {
+        if (chunk.error_line != 0) {
+            std::cerr << "ERROR: Line " << line_base + chunk.error_line << ": " << chunk.error << "\n";
+            return false;
+        }
+        line_base += chunk.lines;
+        total += chunk.operations.size();
+    }
+
+    out.reserve(total);
+    for (auto &chunk: chunks) {
+        out.append(chunk.operations);
+        chunk.operations.clear();
+    }
+    out.release_index();
+
+    std::cout << "  Loaded " << out.size() << " operations, " << out.num_keys() << " distinct keys\n";
+    return true;
+}
+
+// ============================================================================
+// Load a .btrace file via mmap - the dictionary is copied as is
+// ============================================================================
+inline bool load_btrace_mmap(const std::string &path,
+                             RunMetaData &runMeta,
+                             OperationStream &out) {
+    out.clear();
+
+    MappedFile file;
+    if (!file.map(path)) {
+        std::cerr << "ERROR: Cannot map trace file: " << path << "\n";
+        return false;
+    }
+
+    BinaryTraceView view;
+    std::string error;
+    if (!openBinaryTrace(file.data(), file.size(), view, error)) {
+        std::cerr << "ERROR: " << path << ": " << error << "\n";
+        return false;
+    }
+    runMeta.profile = view.profile;
+    runMeta.N = static_cast<int>(view.N);
+    runMeta.seed = static_cast<int>(view.seed);
+
+    std::cout << "Loaded trace: " << runMeta.profile << " N=" << runMeta.N << " seed=" << runMeta.seed
+              << " (" << view.keyCount << " distinct keys)\n";
+
+    out.assign_dictionary(view.keyBytes, view.keyOffsets, view.keyCount);
+    out.reserve(view.opCount);
+    const bool ok = decodeBinaryTraceOps(view, [&](char op, std::uint64_t keyId) {
+        OpCode tag = OpCode::Insert;
+        opcodeFromLetter(op, tag);
+        out.push_back(tag, static_cast<std::uint32_t>(keyId));
+    });
+    if (!ok) {
+        std::cerr << "ERROR: " << path << ": corrupt .btrace op stream\n";
+        return false;
+    }
+
+    std::cout << "  Loaded " << out.size() << " operations\n";
+    return true;
+}
+
+// Picks the loader by extension: .btrace is binary, anything else is text.
+inline bool load_any_trace(const std::string &path,
+                           RunMetaData &runMeta,
+                           OperationStream &out,
+                           unsigned num_threads = 0) {
+    const std::string binary_suffix = ".btrace";
+    if (path.size() >= binary_suffix.size() &&
+        path.compare(path.size() - binary_suffix.size(), binary_suffix.size(), binary_suffix) == 0)
+        return load_btrace_mmap(path, runMeta, out);
+    return load_trace_mmap(path, runMeta, out, num_threads);
+}
@@ -0,0 +1,93 @@
+//
+// MemoryAccounting.cpp - Counting replacements for global operator new / delete
+//
+// Every form is replaced (plain, array, nothrow, sized and over-aligned), so
+// each allocation and its deallocation go through the same malloc/free pair
+// whichever form the compiler picks, and ASan sees matching calls.
+//
+
+#include "MemoryAccounting.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+
+namespace {
+void *accounted_malloc(std::size_t size, std::size_t alignment) {
+    if (size == 0)
+        size = 1;
+    void *p;
+    while ((p = alignment <= alignof(std::max_align_t)
+                ? std::malloc(size)
+                : std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)) == nullptr) {
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr)
+            return nullptr;
+        handler();
+    }
+
+    if (heap_accounting_enabled()) {
+        auto &counters = memory_accounting_detail::thread_counters;
+        const auto bytes = static_cast<std::int64_t>(malloc_usable_size(p));
+        ++counters.allocations;
+        counters.allocated_bytes += bytes;
+        counters.live_bytes += bytes;
+        if (counters.live_bytes > counters.peak_live_bytes)
+            counters.peak_live_bytes = counters.live_bytes;
+    }
+    return p;
+}
+
+void *accounted_new(std::size_t size, std::size_t alignment) {
+    void *p = accounted_malloc(size, alignment);
+    if (p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
+
+void accounted_free(void *p) noexcept {
+    if (p == nullptr)
+        return;
+    if (heap_accounting_enabled())
+        memory_accounting_detail::thread_counters.live_bytes -= static_cast<std::int64_t>(malloc_usable_size(p));
+    std::free(p);
+}
+
+constexpr std::size_t DEFAULT_ALIGNMENT = alignof(std::max_align_t);
+} // namespace
+
+void *operator new(std::size_t size) { return accounted_new(size, DEFAULT_ALIGNMENT); }
+void *operator new[](std::size_t size) { return accounted_new(size, DEFAULT_ALIGNMENT); }
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    return accounted_new(size, static_cast<std::size_t>(alignment));
+}
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+    return accounted_new(size, static_cast<std::size_t>(alignment));
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    return accounted_malloc(size, DEFAULT_ALIGNMENT);
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    return accounted_malloc(size, DEFAULT_ALIGNMENT);
+}
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return accounted_malloc(size, static_cast<std::size_t>(alignment));
+}
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return accounted_malloc(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *p) noexcept { accounted_free(p); }
+void operator delete[](void *p) noexcept { accounted_free(p); }
+void operator delete(void *p, std::size_t) noexcept { accounted_free(p); }
+void operator delete[](void *p, std::size_t) noexcept { accounted_free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { accounted_free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { accounted_free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { accounted_free(p); }
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { accounted_free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { accounted_free(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { accounted_free(p); }
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept { accounted_free(p); }
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t &) noexcept { accounted_free(p); }
@@ -0,0 +1,100 @@
+//
+// MemoryAccounting.h - Heap and resident-memory accounting for the harness
+//
+// MemoryAccounting.cpp replaces the global operator new / operator delete.
+// Once enable_heap_accounting() has been called, every allocation is
+// counted against the calling thread: allocations, bytes allocated, and
+// bytes live now and at their peak. Sizes are malloc_usable_size(), so they
+// include the allocator's rounding. A HeapScope measures one stretch of a
+// thread's work; the resident set comes from /proc/self/status.
+//
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+struct ThreadHeapCounters {
+    std::int64_t allocations = 0;
+    std::int64_t allocated_bytes = 0;
+    std::int64_t live_bytes = 0;  // can go negative when freeing another thread's blocks
+    std::int64_t peak_live_bytes = 0;
+};
+
+namespace memory_accounting_detail {
+inline std::atomic<bool> enabled{false};
+inline thread_local ThreadHeapCounters thread_counters;
+} // namespace memory_accounting_detail
+
+// Call once, before the first job starts; counting stays on afterwards.
+inline void enable_heap_accounting() {
+    memory_accounting_detail::enabled.store(true, std::memory_order_relaxed);
+}
+
+inline bool heap_accounting_enabled() {
+    return memory_accounting_detail::enabled.load(std::memory_order_relaxed);
+}
+
+// ============================================================================
+// /proc/self/status
+// ============================================================================
+// A field such as "VmHWM" (peak resident set) or "VmRSS" in kB, or -1.
+inline long proc_status_kb(const std::string &field) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, field.size(), field) == 0 && line.size() > field.size() && line[field.size()] == ':')
+            return std::stol(line.substr(field.size() + 1));
+    }
+    return -1;
+}
+
+// Resets VmHWM to the current resident set (Linux 4.0+); false if the
+// kernel does not allow it, in which case VmHWM stays the process peak.
+inline bool reset_peak_rss() {
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+    clear_refs.flush();
+    return static_cast<bool>(clear_refs);
+}
+
+// ============================================================================
+// One measured stretch of the calling thread
+// ============================================================================
+struct MemorySummary {
+    bool recorded = false;
+    long peak_rss_kb = -1;
+    std::int64_t peak_heap_bytes = 0;      // highest live bytes above the start
+    std::int64_t allocations = 0;
+    std::int64_t allocated_bytes = 0;
+    std::int64_t retained_heap_bytes = 0;  // live bytes above the start at the end
+    double bytes_per_key = 0;              // retained bytes per resident key
+};
+
+class HeapScope {
+public:
+    HeapScope() {
+        reset_peak_rss();
+        // The peak is tracked from here on.
+        start_ = memory_accounting_detail::thread_counters;
+        memory_accounting_detail::thread_counters.peak_live_bytes = start_.live_bytes;
+    }
+
+    MemorySummary sample(std::int64_t resident_keys) const {
+        const ThreadHeapCounters now = memory_accounting_detail::thread_counters;
+        MemorySummary s;
+        s.recorded = true;
+        s.peak_heap_bytes = now.peak_live_bytes - start_.live_bytes;
+        s.allocations = now.allocations - start_.allocations;
+        s.allocated_bytes = now.allocated_bytes - start_.allocated_bytes;
+        s.retained_heap_bytes = now.live_bytes - start_.live_bytes;
+        s.bytes_per_key = resident_keys > 0
+                          ? static_cast<double>(s.retained_heap_bytes) / static_cast<double>(resident_keys) : 0.0;
+        s.peak_rss_kb = proc_status_kb("VmHWM");
+        return s;
+    }
+
+private:
+    ThreadHeapCounters start_;
+};
@@ -0,0 +1,77 @@
+//
+// OpenLoopReplay.h - Rate-controlled (open-loop) replay
+//
+// The timed trials replay back to back: a compaction pause only delays the
+// operations after it, and that delay never appears in any measurement.
+// An open-loop pass instead gives every operation an intended start time
+// from an arrival process at a target rate, waits until that time when
+// running early, and measures each response from the intended start. An
+// operation queued behind a compaction is charged the time it waited, as a
+// request arriving at that rate would be (coordinated-omission correction).
+//
+// A rate is sustainable when the pass keeps up with it: the achieved
+// throughput is within 1% of the target. Sweeping rates locates the knee,
+// past which response times grow with the length of the trace.
+//
+
+#pragma once
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include "LatencyHistogram.h"
+
+enum class ArrivalProcess {
+    Constant,  // evenly spaced
+    Poisson    // exponential gaps, same mean
+};
+
+inline const char *arrival_process_name(ArrivalProcess arrivals) {
+    return arrivals == ArrivalProcess::Poisson ? "poisson" : "constant";
+}
+
+// Gaps between intended start times, in nanoseconds. The Poisson generator
+// has a fixed seed, so every configuration sees the same arrivals.
+class ArrivalSchedule {
+public:
+    ArrivalSchedule(double ops_per_sec, ArrivalProcess arrivals)
+        : mean_gap_ns_(1e9 / ops_per_sec), arrivals_(arrivals), rng_(0xa77), gap_(1.0 / mean_gap_ns_) {}
+
+    // Accumulates fractional nanoseconds, so a constant rate does not drift.
+    std::int64_t next_gap_ns() {
+        carry_ += arrivals_ == ArrivalProcess::Poisson ? gap_(rng_) : mean_gap_ns_;
+        const auto whole = static_cast<std::int64_t>(carry_);
+        carry_ -= static_cast<double>(whole);
+        return whole;
+    }
+
+private:
+    double mean_gap_ns_;
+    ArrivalProcess arrivals_;
+    std::mt19937_64 rng_;
+    std::exponential_distribution<double> gap_;
+    double carry_ = 0;
+};
+
+// One rate of the sweep.
+struct OpenLoopPoint {
+    double target_ops_per_sec = 0;
+    double achieved_ops_per_sec = 0;
+    LatencySummary response;  // from intended start to completion
+
+    bool sustainable() const { return achieved_ops_per_sec >= 0.99 * target_ops_per_sec; }
+
+    static std::string csv_header() {
+        return "arrivals,target_ops_per_sec,achieved_ops_per_sec,sustainable,"
+               "response_p50_ns,response_p99_ns,response_p999_ns,response_max_ns";
+    }
+
+    std::string to_csv(ArrivalProcess arrivals) const {
+        std::ostringstream os;
+        os << arrival_process_name(arrivals) << ',' << target_ops_per_sec << ',' << achieved_ops_per_sec << ','
+           << (sustainable() ? 1 : 0) << ',' << response.p50_ns << ',' << response.p99_ns << ','
+           << response.p999_ns << ',' << response.max_ns;
+        return os.str();
+    }
+};
@@ -5,13 +5,29 @@
 #pragma once
 #include <cassert>
 #include <string>
+#include <string_view>
 #include <iostream>
 
 enum class OpCode {
     Insert,     // I key
-    Erase       // E key
+    Erase,      // E key
+    Lookup      // L key
 };
 
+// The trace letter of an opcode, and back; false for an unknown letter.
+inline char opcodeLetter(OpCode tag) {
+    return tag == OpCode::Erase ? 'E' : tag == OpCode::Lookup ? 'L' : 'I';
+}
+
+inline bool opcodeFromLetter(char letter, OpCode &tag) {
+    switch (letter) {
+        case 'I': tag = OpCode::Insert; return true;
+        case 'E': tag = OpCode::Erase; return true;
+        case 'L': tag = OpCode::Lookup; return true;
+        default: return false;
+    }
+}
+
 struct Operation {
     OpCode tag;
     std::string key;   // word/token from the trace
@@ -19,7 +35,7 @@ struct Operation {
     // Constructor for Insert: I key
     Operation(OpCode op_code, std::string k)
         : tag(op_code), key(std::move(k)) {
-        // Both Insert and Erase take a key
+        // Every operation takes a key
     }
 
     void print() const {
@@ -30,6 +46,9 @@ struct Operation {
             case OpCode::Erase:
                 std::cout << "E " << key << std::endl;
                 break;
+            case OpCode::Lookup:
+                std::cout << "L " << key << std::endl;
+                break;
             default:
                 std::cout << "Unknown operation" << std::endl;
         }
@@ -38,4 +57,18 @@ struct Operation {
     // Identify the operation type
     bool isInsert() const { return tag == OpCode::Insert; }
     bool isErase()  const { return tag == OpCode::Erase; }
-};
\ No newline at end of file
+    bool isLookup() const { return tag == OpCode::Lookup; }
+};
+// An operation whose key lives elsewhere (a memory-mapped trace file or a key
+// pool). The referenced bytes must outlive the operation.
+struct OperationRef {
+    OpCode tag;
+    std::string_view key;
+
+    OperationRef(OpCode op_code, std::string_view k)
+        : tag(op_code), key(k) {}
+
+    bool isInsert() const { return tag == OpCode::Insert; }
+    bool isErase()  const { return tag == OpCode::Erase; }
+    bool isLookup() const { return tag == OpCode::Lookup; }
+};
@@ -0,0 +1,145 @@
+//
+// OperationStream.h - Packed, allocation-free in-memory trace
+//
+// Every distinct key is stored once in a contiguous byte pool, and each
+// operation is a single 32-bit word (key_id << TAG_BITS | opcode). Replay walks
+// the op array sequentially; iterating yields OperationRef values whose keys
+// point into the pool. A trace of 28M operations over 4M distinct keys costs
+// ~112 MB of ops plus the pool, instead of one std::string per op.
+//
+
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+#include "Operation.h"
+#include "../HashFunctions.hpp"
+
+class OperationStream {
+public:
+    static constexpr unsigned TAG_BITS = 2;
+    static constexpr std::uint32_t TAG_MASK = (1u << TAG_BITS) - 1;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = OperationRef;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = OperationRef;
+
+        const_iterator(const OperationStream *stream, const std::uint32_t *op) : stream_(stream), op_(op) {}
+
+        OperationRef operator*() const { return stream_->decode(*op_); }
+        const_iterator &operator++() {
+            ++op_;
+            return *this;
+        }
+        const_iterator operator+(difference_type n) const { return {stream_, op_ + n}; }
+        difference_type operator-(const const_iterator &other) const { return op_ - other.op_; }
+        bool operator==(const const_iterator &other) const { return op_ == other.op_; }
+        bool operator!=(const const_iterator &other) const { return op_ != other.op_; }
+
+    private:
+        const OperationStream *stream_;
+        const std::uint32_t *op_;
+    };
+
+    void clear() {
+        key_pool_.clear();
+        key_offsets_.assign(1, 0);
+        ops_.clear();
+        index_.clear();
+    }
+
+    void reserve(std::size_t num_ops) { ops_.reserve(num_ops); }
+
+    // Returns the id of `key`, adding it to the pool on first sight.
+    std::uint32_t intern(std::string_view key) {
+        if (2 * (num_keys() + 1) > index_.size()) {
+            std::size_t slots = 1024;
+            while (slots < 4 * (num_keys() + 1))
+                slots *= 2;
+            rebuild_index(slots);
+        }
+
+        const std::size_t mask = index_.size() - 1;
+        for (std::size_t slot = fnv1aHash64(key) & mask;; slot = (slot + 1) & mask) {
+            if (index_[slot] == 0) {
+                const auto id = static_cast<std::uint32_t>(num_keys());
+                key_pool_.insert(key_pool_.end(), key.begin(), key.end());
+                key_offsets_.push_back(static_cast<std::uint32_t>(key_pool_.size()));
+                index_[slot] = id + 1;
+                return id;
+            }
+            if (this->key(index_[slot] - 1) == key)
+                return index_[slot] - 1;
+        }
+    }
+
+    void push_back(OpCode tag, std::uint32_t key_id) {
+        ops_.push_back((key_id << TAG_BITS) | static_cast<std::uint32_t>(tag));
+    }
+    void push_back(OpCode tag, std::string_view key) { push_back(tag, intern(key)); }
+
+    // Appends other's operations, mapping its key ids into this dictionary.
+    void append(const OperationStream &other) {
+        std::vector<std::uint32_t> remap(other.num_keys());
+        for (std::size_t id = 0; id < remap.size(); ++id)
+            remap[id] = intern(other.key(static_cast<std::uint32_t>(id)));
+        ops_.reserve(ops_.size() + other.ops_.size());
+        for (auto op: other.ops_)
+            ops_.push_back((remap[op >> TAG_BITS] << TAG_BITS) | (op & TAG_MASK));
+    }
+
+    // Replaces the dictionary with num_keys keys given as a byte pool and
+    // num_keys + 1 offsets (the .btrace layout). Clears the operations.
+    void assign_dictionary(const char *bytes, const std::uint32_t *offsets, std::size_t num_keys) {
+        clear();
+        key_pool_.assign(bytes, bytes + offsets[num_keys]);
+        key_offsets_.assign(offsets, offsets + num_keys + 1);
+    }
+
+    // The interning index is only needed while building.
+    void release_index() {
+        std::vector<std::uint32_t>().swap(index_);
+    }
+
+    [[nodiscard]] std::size_t size() const { return ops_.size(); }
+    [[nodiscard]] bool empty() const { return ops_.empty(); }
+    [[nodiscard]] std::size_t num_keys() const { return key_offsets_.size() - 1; }
+    [[nodiscard]] std::string_view key(std::uint32_t id) const {
+        return {key_pool_.data() + key_offsets_[id], key_offsets_[id + 1] - key_offsets_[id]};
+    }
+    [[nodiscard]] std::size_t memory_bytes() const {
+        return key_pool_.capacity() + 4 * (key_offsets_.capacity() + ops_.capacity() + index_.capacity());
+    }
+
+    OperationRef operator[](std::size_t i) const { return decode(ops_[i]); }
+    const_iterator begin() const { return {this, ops_.data()}; }
+    const_iterator end() const { return {this, ops_.data() + ops_.size()}; }
+
+private:
+    OperationRef decode(std::uint32_t op) const {
+        return {static_cast<OpCode>(op & TAG_MASK), key(op >> TAG_BITS)};
+    }
+
+    void rebuild_index(std::size_t slots) {
+        index_.assign(slots, 0);
+        const std::size_t mask = slots - 1;
+        for (std::uint32_t id = 0; id < num_keys(); ++id) {
+            std::size_t slot = fnv1aHash64(key(id)) & mask;
+            while (index_[slot] != 0)
+                slot = (slot + 1) & mask;
+            index_[slot] = id + 1;
+        }
+    }
+
+    std::vector<char> key_pool_;
+    std::vector<std::uint32_t> key_offsets_{0};
+    std::vector<std::uint32_t> ops_;
+    std::vector<std::uint32_t> index_;  // open addressing over key ids, id + 1 (0 = empty)
+};
@@ -0,0 +1,129 @@
+//
+// PerfCounters.h - Hardware performance counters via perf_event_open
+//
+// Each counter is opened on its own (not as a group), so one event the CPU or
+// VM does not expose only loses that column. Counters count user space of the
+// calling thread only, which perf_event_paranoid <= 2 allows without
+// privileges. When the kernel multiplexes counters, each reading is scaled by
+// time_enabled / time_running, as perf stat does.
+//
+
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Counts per replayed operation; a negative value means the counter was not
+// available on this machine.
+struct PerfSummary {
+    static constexpr std::size_t NUM_EVENTS = 6;
+    std::array<double, NUM_EVENTS> per_op;
+
+    PerfSummary() { per_op.fill(-1.0); }
+
+    static const char *column(std::size_t i) {
+        static const char *const names[NUM_EVENTS] = {
+            "cycles_per_op", "instructions_per_op", "l1d_misses_per_op",
+            "llc_misses_per_op", "dtlb_misses_per_op", "branch_misses_per_op",
+        };
+        return names[i];
+    }
+};
+
+class PerfCounters {
+public:
+    PerfCounters() {
+        fds_.fill(-1);
+        totals_.fill(0.0);
+        const std::array<std::pair<std::uint32_t, std::uint64_t>, PerfSummary::NUM_EVENTS> events = {{
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_L1D)},
+            {PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_LL)},
+            {PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_DTLB)},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        }};
+        for (std::size_t i = 0; i < events.size(); ++i)
+            fds_[i] = open_event(events[i].first, events[i].second);
+    }
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    ~PerfCounters() {
+        for (int fd: fds_) {
+            if (fd >= 0)
+                ::close(fd);
+        }
+    }
+
+    bool any_available() const {
+        for (int fd: fds_) {
+            if (fd >= 0)
+                return true;
+        }
+        return false;
+    }
+
+    // Brackets one timed region; readings accumulate across regions.
+    void start() {
+        for (int fd: fds_) {
+            if (fd >= 0) {
+                ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+    }
+
+    void stop() {
+        for (std::size_t i = 0; i < fds_.size(); ++i) {
+            if (fds_[i] < 0)
+                continue;
+            ::ioctl(fds_[i], PERF_EVENT_IOC_DISABLE, 0);
+            std::uint64_t reading[3] = {0, 0, 0};  // value, time_enabled, time_running
+            if (::read(fds_[i], reading, sizeof(reading)) != static_cast<ssize_t>(sizeof(reading)))
+                continue;
+            double value = static_cast<double>(reading[0]);
+            if (reading[2] != 0 && reading[2] < reading[1])
+                value *= static_cast<double>(reading[1]) / static_cast<double>(reading[2]);
+            totals_[i] += value;
+        }
+    }
+
+    PerfSummary per_op(std::uint64_t total_ops) const {
+        PerfSummary s;
+        for (std::size_t i = 0; i < fds_.size(); ++i) {
+            if (fds_[i] >= 0 && total_ops != 0)
+                s.per_op[i] = totals_[i] / static_cast<double>(total_ops);
+        }
+        return s;
+    }
+
+private:
+    static std::uint64_t cache_event(std::uint64_t cache) {
+        return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    }
+
+    static int open_event(std::uint32_t type, std::uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    std::array<int, PerfSummary::NUM_EVENTS> fds_;
+    std::array<double, PerfSummary::NUM_EVENTS> totals_;
+};
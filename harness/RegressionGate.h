@@ -0,0 +1,430 @@
+//
+// RegressionGate.h - Compare a sweep against a stored baseline
+//
+// --write-baseline saves each run's timing and structural metrics, with the
+// environment that produced them, as JSON. --baseline compares the current
+// runs against such a file, matching runs by implementation, trace and sweep
+// parameters. The structural metrics (total_probes, compactions,
+// max_in_table) are deterministic for a trace and seed (siphash and fast are
+// keyed from the run's hash seed, which is part of the match), so by default
+// any increase on any machine is a regression; a decrease is reported as an
+// improvement and does not fail the gate. Timing is only compared when the CPU
+// model matches, and then a run regresses when its median is slower by more
+// than the tolerance and its confidence interval clears the baseline's.
+//
+
+#pragma once
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "RunResults.h"
+
+// Generated on every CMake build; absent when compiled by hand.
+#if __has_include("HarnessGitRevision.h")
+#include "HarnessGitRevision.h"
+#endif
+#ifndef HARNESS_GIT_REVISION
+#define HARNESS_GIT_REVISION "unknown"
+#endif
+#ifndef HARNESS_BUILD_FLAGS
+#define HARNESS_BUILD_FLAGS "unknown"
+#endif
+
+// ============================================================================
+// Environment the numbers came from
+// ============================================================================
+struct BuildEnvironment {
+    std::string cpu_model;
+    std::string compiler;
+    std::string flags;
+    std::string git_revision;
+
+    static BuildEnvironment current() {
+        BuildEnvironment env;
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(cpuinfo, line)) {
+            if (line.rfind("model name", 0) == 0) {
+                const auto colon = line.find(':');
+                env.cpu_model = colon == std::string::npos ? "" : line.substr(line.find_first_not_of(' ', colon + 1));
+                break;
+            }
+        }
+        if (env.cpu_model.empty())
+            env.cpu_model = "unknown";
+#if defined(__clang__)
+        env.compiler = std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+        env.compiler = std::string("gcc ") + __VERSION__;
+#else
+        env.compiler = "unknown";
+#endif
+        env.flags = HARNESS_BUILD_FLAGS;
+        env.git_revision = HARNESS_GIT_REVISION;
+        return env;
+    }
+};
+
+// ============================================================================
+// What is stored per run
+// ============================================================================
+struct BaselineRun {
+    std::string key;  // impl, trace and sweep parameters; see key_of()
+    double elapsed_ms = 0;
+    double ci_low_ms = 0;
+    double ci_high_ms = 0;
+    // -1 = not reported by this implementation
+    std::int64_t total_probes = -1;
+    std::int64_t compactions = -1;
+    std::int64_t max_in_table = -1;
+
+    static std::string key_of(const RunResult &run) {
+        std::ostringstream os;
+        os << run.impl << " " << run.trace_path << " hash=" << run.hash_policy
+           << " trigger=" << run.compaction_trigger << " load=" << run.target_load_factor
+           << " mode=" << run.trial_mode();
+        if (run.hash_seed >= 0)
+            os << " seed=" << run.hash_seed;
+        if (run.batch_hash)
+            os << " batch_hash";
+        return os.str();
+    }
+
+    static BaselineRun from(const RunResult &run) {
+        BaselineRun b;
+        b.key = key_of(run);
+        b.elapsed_ms = run.elapsed_ms();
+        b.ci_low_ms = static_cast<double>(run.ci_low_ns) / 1e6;
+        b.ci_high_ms = static_cast<double>(run.ci_high_ns) / 1e6;
+
+        // table_size,active,available,tombstones,total_probes,table_inserts,
+        // table_deletes,lookups,full_scans,compactions,max_in_table,...
+        std::vector<std::string> fields;
+        std::istringstream in(run.hash_table_stats_csv);
+        std::string field;
+        while (std::getline(in, field, ','))
+            fields.push_back(field);
+        auto count = [&fields](std::size_t i) -> std::int64_t {
+            return i < fields.size() && !fields[i].empty() ? std::stoll(fields[i]) : -1;
+        };
+        b.total_probes = count(4);
+        b.compactions = count(9);
+        b.max_in_table = count(10);
+        return b;
+    }
+};
+
+struct RegressionTolerance {
+    double time = 0.10;       // relative slowdown of the median allowed
+    double structural = 0.0;  // relative increase of a structural metric allowed
+};
+
+// ============================================================================
+// Minimal JSON, enough for the files written below
+// ============================================================================
+namespace regression_json {
+
+inline std::string quote(const std::string &s) {
+    std::string out = "\"";
+    for (char c: s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out += ' ';
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+struct Value {
+    enum Type { NUL, NUMBER, STRING, ARRAY, OBJECT } type = NUL;
+    double number = 0;
+    std::string string;
+    std::vector<Value> array;
+    std::vector<std::pair<std::string, Value>> object;
+
+    const Value *get(const std::string &name) const {
+        for (const auto &member: object) {
+            if (member.first == name)
+                return &member.second;
+        }
+        return nullptr;
+    }
+    std::string get_string(const std::string &name) const {
+        const Value *v = get(name);
+        return v != nullptr && v->type == STRING ? v->string : "";
+    }
+    double get_number(const std::string &name, double fallback) const {
+        const Value *v = get(name);
+        return v != nullptr && v->type == NUMBER ? v->number : fallback;
+    }
+};
+
+class Parser {
+public:
+    explicit Parser(const std::string &text) : text_(text) {}
+
+    bool parse(Value &out) {
+        if (!value(out))
+            return false;
+        skip_space();
+        return pos_ == text_.size();
+    }
+
+private:
+    void skip_space() {
+        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_])))
+            ++pos_;
+    }
+
+    bool literal(const char *word) {
+        const std::string w(word);
+        if (text_.compare(pos_, w.size(), w) != 0)
+            return false;
+        pos_ += w.size();
+        return true;
+    }
+
+    bool string(std::string &out) {
+        if (text_[pos_] != '"')
+            return false;
+        for (++pos_; pos_ < text_.size(); ++pos_) {
+            char c = text_[pos_];
+            if (c == '"') {
+                ++pos_;
+                return true;
+            }
+            if (c == '\\') {
+                if (++pos_ == text_.size())
+                    return false;
+                c = text_[pos_];
+                c = c == 'n' ? '\n' : c == 't' ? '\t' : c;
+            }
+            out += c;
+        }
+        return false;
+    }
+
+    bool value(Value &out) {
+        skip_space();
+        if (pos_ == text_.size())
+            return false;
+        const char c = text_[pos_];
+        if (c == '{') {
+            out.type = Value::OBJECT;
+            ++pos_;
+            skip_space();
+            if (pos_ < text_.size() && text_[pos_] == '}') {
+                ++pos_;
+                return true;
+            }
+            for (;;) {
+                std::string name;
+                Value member;
+                skip_space();
+                if (pos_ == text_.size() || !string(name))
+                    return false;
+                skip_space();
+                if (pos_ == text_.size() || text_[pos_++] != ':' || !value(member))
+                    return false;
+                out.object.emplace_back(std::move(name), std::move(member));
+                skip_space();
+                if (pos_ == text_.size())
+                    return false;
+                if (text_[pos_] == '}') {
+                    ++pos_;
+                    return true;
+                }
+                if (text_[pos_++] != ',')
+                    return false;
+            }
+        }
+        if (c == '[') {
+            out.type = Value::ARRAY;
+            ++pos_;
+            skip_space();
+            if (pos_ < text_.size() && text_[pos_] == ']') {
+                ++pos_;
+                return true;
+            }
+            for (;;) {
+                Value element;
+                if (!value(element))
+                    return false;
+                out.array.push_back(std::move(element));
+                skip_space();
+                if (pos_ == text_.size())
+                    return false;
+                if (text_[pos_] == ']') {
+                    ++pos_;
+                    return true;
+                }
+                if (text_[pos_++] != ',')
+                    return false;
+            }
+        }
+        if (c == '"') {
+            out.type = Value::STRING;
+            return string(out.string);
+        }
+        if (literal("null")) {
+            out.type = Value::NUL;
+            return true;
+        }
+        std::size_t used = 0;
+        try {
+            out.number = std::stod(text_.substr(pos_, 32), &used);
+        } catch (const std::exception &) {
+            return false;
+        }
+        out.type = Value::NUMBER;
+        pos_ += used;
+        return true;
+    }
+
+    const std::string &text_;
+    std::size_t pos_ = 0;
+};
+
+} // namespace regression_json
+
+// ============================================================================
+// Writing and reading a baseline
+// ============================================================================
+inline bool write_baseline(const std::string &path, const BuildEnvironment &env, const std::vector<RunResult> &runs) {
+    using regression_json::quote;
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        std::cerr << "ERROR: cannot open " << path << " for writing\n";
+        return false;
+    }
+    out.precision(10);
+    out << "{\n  \"environment\": {\n"
+        << "    \"cpu_model\": " << quote(env.cpu_model) << ",\n"
+        << "    \"compiler\": " << quote(env.compiler) << ",\n"
+        << "    \"flags\": " << quote(env.flags) << ",\n"
+        << "    \"git_revision\": " << quote(env.git_revision) << "\n"
+        << "  },\n  \"runs\": [";
+    for (std::size_t i = 0; i < runs.size(); ++i) {
+        const BaselineRun b = BaselineRun::from(runs[i]);
+        out << (i == 0 ? "\n" : ",\n")
+            << "    {\"key\": " << quote(b.key) << ", \"elapsed_ms\": " << b.elapsed_ms
+            << ", \"ci_low_ms\": " << b.ci_low_ms << ", \"ci_high_ms\": " << b.ci_high_ms
+            << ", \"total_probes\": " << b.total_probes << ", \"compactions\": " << b.compactions
+            << ", \"max_in_table\": " << b.max_in_table << "}";
+    }
+    out << "\n  ]\n}\n";
+    return static_cast<bool>(out);
+}
+
+inline bool load_baseline(const std::string &path, BuildEnvironment &env, std::vector<BaselineRun> &runs) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "ERROR: Cannot open baseline: " << path << "\n";
+        return false;
+    }
+    std::ostringstream text;
+    text << in.rdbuf();
+    const std::string json = text.str();
+
+    regression_json::Value root;
+    const regression_json::Value *list = nullptr;
+    if (!regression_json::Parser(json).parse(root) || (list = root.get("runs")) == nullptr ||
+        list->type != regression_json::Value::ARRAY) {
+        std::cerr << "ERROR: " << path << " is not a baseline written by --write-baseline\n";
+        return false;
+    }
+    if (const auto *e = root.get("environment")) {
+        env.cpu_model = e->get_string("cpu_model");
+        env.compiler = e->get_string("compiler");
+        env.flags = e->get_string("flags");
+        env.git_revision = e->get_string("git_revision");
+    }
+    for (const auto &item: list->array) {
+        BaselineRun b;
+        b.key = item.get_string("key");
+        b.elapsed_ms = item.get_number("elapsed_ms", 0);
+        b.ci_low_ms = item.get_number("ci_low_ms", 0);
+        b.ci_high_ms = item.get_number("ci_high_ms", 0);
+        b.total_probes = static_cast<std::int64_t>(item.get_number("total_probes", -1));
+        b.compactions = static_cast<std::int64_t>(item.get_number("compactions", -1));
+        b.max_in_table = static_cast<std::int64_t>(item.get_number("max_in_table", -1));
+        runs.push_back(b);
+    }
+    return true;
+}
+
+// ============================================================================
+// The comparison
+// ============================================================================
+// Prints one line per difference and returns the number of regressions.
+inline int check_regressions(const BuildEnvironment &baseline_env,
+                             const std::vector<BaselineRun> &baseline,
+                             const BuildEnvironment &env,
+                             const std::vector<RunResult> &runs,
+                             const RegressionTolerance &tolerance) {
+    std::cout << "\nBaseline: git " << baseline_env.git_revision << ", " << baseline_env.compiler
+              << ", " << baseline_env.cpu_model << "\n";
+    const bool same_cpu = baseline_env.cpu_model == env.cpu_model;
+    if (!same_cpu)
+        std::cout << "  CPU differs (" << env.cpu_model << "); timing not compared\n";
+    if (baseline_env.compiler != env.compiler || baseline_env.flags != env.flags)
+        std::cout << "  Compiler or flags differ (" << env.compiler << ", " << env.flags << ")\n";
+
+    std::map<std::string, const BaselineRun *> by_key;
+    for (const auto &b: baseline)
+        by_key[b.key] = &b;
+
+    int regressions = 0;
+    auto structural = [&](const std::string &key, const char *metric, std::int64_t was, std::int64_t now) {
+        if (was < 0 || now < 0 || was == now)
+            return;
+        const double change = static_cast<double>(now - was) / static_cast<double>(std::max<std::int64_t>(was, 1));
+        const bool regressed = change > tolerance.structural;
+        regressions += regressed ? 1 : 0;
+        std::cout << "  " << (regressed ? "REGRESSION " : change < 0 ? "improved   " : "changed    ") << key << ": " << metric << " "
+                  << was << " -> " << now << "\n";
+    };
+
+    for (const auto &run: runs) {
+        const BaselineRun now = BaselineRun::from(run);
+        const auto found = by_key.find(now.key);
+        if (found == by_key.end()) {
+            std::cout << "  new        " << now.key << "\n";
+            continue;
+        }
+        const BaselineRun &was = *found->second;
+        by_key.erase(found);
+
+        structural(now.key, "total_probes", was.total_probes, now.total_probes);
+        structural(now.key, "compactions", was.compactions, now.compactions);
+        structural(now.key, "max_in_table", was.max_in_table, now.max_in_table);
+
+        if (same_cpu && was.elapsed_ms > 0) {
+            const double slowdown = now.elapsed_ms / was.elapsed_ms - 1.0;
+            if (slowdown > tolerance.time && now.ci_low_ms > was.ci_high_ms) {
+                ++regressions;
+                std::cout << "  REGRESSION " << now.key << ": " << was.elapsed_ms << " ms -> " << now.elapsed_ms
+                          << " ms (+" << slowdown * 100 << "%)\n";
+            }
+        }
+    }
+    for (const auto &missing: by_key)
+        std::cout << "  not run    " << missing.first << "\n";
+
+    std::cout << (regressions == 0 ? "No regressions" : std::to_string(regressions) + " regression(s)")
+              << " against the baseline\n";
+    return regressions;
+}
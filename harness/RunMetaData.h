@@ -5,8 +5,6 @@
 #ifndef PRIORITY_QUEUE_STUDY_RUNPARAMS_HPP
 #define PRIORITY_QUEUE_STUDY_RUNPARAMS_HPP
 
-#endif //PRIORITY_QUEUE_STUDY_RUNPARAMS_HPP
-
 #include <string>
 struct RunMetaData {
 
@@ -16,3 +14,5 @@ struct RunMetaData {
     int seed = 0;   // RNG seed used to generate the trace
 
 };
+
+#endif //PRIORITY_QUEUE_STUDY_RUNPARAMS_HPP
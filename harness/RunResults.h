@@ -2,8 +2,15 @@
 #include <string>
 #include <cstdint>
 #include <sstream>
+#include <initializer_list>
+#include <vector>
 
 #include "RunMetaData.h"
+#include "LatencyHistogram.h"
+#include "PerfCounters.h"
+#include "WindowSeries.h"
+#include "MemoryAccounting.h"
+#include "OpenLoopReplay.h"
 
 struct RunResult {
     // identifiers
@@ -15,17 +22,63 @@ struct RunResult {
 
     // timing
     std::int64_t elapsed_ns = 0;   // total replay time (nanoseconds)
+    std::size_t trials = 0;        // timed trials behind the median
+    std::int64_t ci_low_ns = 0;    // 95% bootstrap CI of the median
+    std::int64_t ci_high_ns = 0;
+    std::size_t outliers = 0;      // trials outside Tukey's fences
+
+    // per-window time series from an extra pass (empty = not recorded)
+    std::uint64_t window_ops = 0;
+    std::vector<WindowRow> windows;
 
     // operation counts (for LRU hash table)
     long inserts = 0;  // 'I'
     long erases  = 0;  // 'E'
+    long lookups = 0;  // 'L'
+
+    // sweep parameters not covered by csvStats()
+    std::string hash_policy = "polynomial";
+    long long hash_seed = -1;          // keyed policies' seed, -1 = unkeyed
+    double compaction_trigger = 0.95;  // 0 when compaction is off
+    double target_load_factor = 0.0;   // 0 = table size from Section 4.4
+    bool batch_hash = false;           // keys hashed a batch at a time (hash_map)
 
     // Hash table statistics (will be populated from HashTableDictionary::csvStats())
     std::string hash_table_stats_csv = "";
 
+    // per-operation latency, from an extra untimed pass (0 = not recorded,
+    // k = every k-th operation was timed)
+    unsigned latency_sample_every = 0;
+    LatencySummary insert_latency;
+    LatencySummary erase_latency;
+    LatencySummary lookup_latency;
+
+    // hardware counters over the timed trials, per operation (negative =
+    // counter unavailable or not collected)
+    bool collect_perf = false;
+    PerfSummary perf;
+
+    // how each timed trial started: caches evicted first, and/or in a forked child
+    bool cold_cache = false;
+    bool fork_trials = false;
+
+    // open-loop passes, one per target rate (empty = not run)
+    std::vector<double> open_loop_rates;
+    ArrivalProcess arrivals = ArrivalProcess::Constant;
+    std::vector<OpenLoopPoint> open_loop;
+
+    // heap and resident memory from a separate pass (recorded = --memory)
+    MemorySummary memory;
+
     // convenience
     long total_ops() const {
-        return inserts + erases;
+        return inserts + erases + lookups;
+    }
+    // warm, cold, fork or cold_fork
+    std::string trial_mode() const {
+        if (fork_trials)
+            return cold_cache ? "cold_fork" : "fork";
+        return cold_cache ? "cold" : "warm";
     }
     double elapsed_ms() const {
         return static_cast<double>(elapsed_ns) / 1e6;
@@ -38,7 +91,8 @@ struct RunResult {
     // CSV helpers
     static std::string csv_header() {
         // From Section 4.5: impl,profile,trace_path,N,seed,elapsed_ms,ops_total,inserts,erases,
-        // followed by hash table's csvStatsHeader()
+        // followed by hash table's csvStatsHeader(). Trace lookups are
+        // ops_total - inserts - erases (and the table's lookups column).
         // The hash table provides its own header, so we'll build our prefix
         return "impl,profile,trace_path,N,seed,elapsed_ms,ops_total,inserts,erases,"
                // Hash table adds: table_size,active,available,tombstones,total_probes,inserts,deletes,
@@ -48,7 +102,19 @@ struct RunResult {
                "table_size,active,available,tombstones,total_probes,table_inserts,table_deletes,"
                "lookups,full_scans,compactions,max_in_table,available_pct,"
                "load_factor_pct,eff_load_factor_pct,tombstones_pct,average_probes,"
-               "probe_type,compaction_state";
+               "probe_type,compaction_state,"
+               "latency_sample_every,"
+               "insert_p50_ns,insert_p99_ns,insert_p999_ns,insert_max_ns,"
+               "erase_p50_ns,erase_p99_ns,erase_p999_ns,erase_max_ns,"
+               "lookup_p50_ns,lookup_p99_ns,lookup_p999_ns,lookup_max_ns,"
+               "cycles_per_op,instructions_per_op,l1d_misses_per_op,"
+               "llc_misses_per_op,dtlb_misses_per_op,branch_misses_per_op,"
+               "hash_policy,compaction_trigger,target_load_factor,"
+               "trials,elapsed_ci_low_ms,elapsed_ci_high_ms,outliers,"
+               "trial_mode,"
+               "peak_rss_kb,peak_heap_bytes,allocations,allocated_bytes,"
+               "retained_heap_bytes,bytes_per_key,"
+               "hash_seed,batch_hash";
     }
 
     std::string to_csv_row() const {
@@ -69,6 +135,93 @@ struct RunResult {
             os << ',' << hash_table_stats_csv;
         }
 
+        // Latency columns stay empty when latencies were not recorded
+        os << ',' << latency_sample_every;
+        for (const auto *latency: {&insert_latency, &erase_latency, &lookup_latency}) {
+            if (latency_sample_every != 0 && latency->count != 0) {
+                os << ',' << latency->p50_ns << ',' << latency->p99_ns
+                   << ',' << latency->p999_ns << ',' << latency->max_ns;
+            } else {
+                os << ",,,,";
+            }
+        }
+
+        // Unavailable counters leave their column empty
+        for (double per_op: perf.per_op) {
+            os << ',';
+            if (per_op >= 0.0)
+                os << per_op;
+        }
+
+        os << ',' << hash_policy << ',' << compaction_trigger << ',' << target_load_factor;
+        os << ',' << trials << ',' << static_cast<double>(ci_low_ns) / 1e6
+           << ',' << static_cast<double>(ci_high_ns) / 1e6 << ',' << outliers;
+        os << ',' << trial_mode();
+
+        if (memory.recorded) {
+            os << ',';
+            if (memory.peak_rss_kb >= 0)
+                os << memory.peak_rss_kb;
+            os << ',' << memory.peak_heap_bytes << ',' << memory.allocations << ',' << memory.allocated_bytes
+               << ',' << memory.retained_heap_bytes << ',' << memory.bytes_per_key;
+        } else {
+            os << ",,,,,,";
+        }
+
+        os << ',';
+        if (hash_seed >= 0)
+            os << hash_seed;
+        os << ',' << (batch_hash ? 1 : 0);
+
+        return os.str();
+    }
+
+    // Side CSVs (time series, open-loop sweep) start with these columns, so
+    // their rows can be joined to the run rows.
+    static std::string side_csv_identifiers() {
+        return "impl,profile,trace_path,N,seed,probe_type,compaction_state,hash_policy,"
+               "compaction_trigger,target_load_factor,";
+    }
+
+    // Time-series CSV: one row per window.
+    static std::string windows_csv_header() {
+        return side_csv_identifiers() + WindowRow::csv_header();
+    }
+
+    std::string windows_to_csv() const {
+        const std::string identifiers = side_csv_prefix();
+        std::ostringstream os;
+        for (const auto &window: windows)
+            os << identifiers << window.to_csv() << '\n';
+        return os.str();
+    }
+
+    // Open-loop CSV: one row per target rate.
+    static std::string open_loop_csv_header() {
+        return side_csv_identifiers() + OpenLoopPoint::csv_header();
+    }
+
+    std::string open_loop_to_csv() const {
+        const std::string identifiers = side_csv_prefix();
+        std::ostringstream os;
+        for (const auto &point: open_loop)
+            os << identifiers << point.to_csv(arrivals) << '\n';
+        return os.str();
+    }
+
+private:
+    std::string side_csv_prefix() const {
+        // probe_type and compaction_state are the last two csvStats() columns
+        const auto state_comma = hash_table_stats_csv.rfind(',');
+        const auto probe_comma = state_comma == std::string::npos ? std::string::npos
+                                 : hash_table_stats_csv.rfind(',', state_comma - 1);
+        const std::string probe_and_state = probe_comma == std::string::npos
+                                            ? "," : hash_table_stats_csv.substr(probe_comma + 1);
+
+        std::ostringstream os;
+        os << impl << ',' << run_meta_data.profile << ',' << trace_path << ','
+           << run_meta_data.N << ',' << run_meta_data.seed << ',' << probe_and_state << ','
+           << hash_policy << ',' << compaction_trigger << ',' << target_load_factor << ',';
         return os.str();
     }
-};
\ No newline at end of file
+};
@@ -0,0 +1,246 @@
+//
+// StreamingTrace.h - Bounded-memory streaming replay for the LRU harness
+//
+// Instead of materializing the whole trace, each pass starts a reader thread
+// that reads and decodes the file in fixed-size chunks and hands them to the
+// replay thread through a two-slot queue: one chunk is being replayed while
+// the other is being filled. Memory stays at two chunks regardless of trace
+// length. Every pass re-reads the file, so repeated trials are served from
+// the page cache.
+//
+
+#pragma once
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "MappedTrace.h"
+
+class StreamingTrace {
+public:
+    static constexpr std::size_t DEFAULT_CHUNK_BYTES = std::size_t{8} << 20;
+
+    // Reads only the header (the dictionary section for .btrace).
+    bool open(const std::string &path, RunMetaData &runMeta,
+              std::size_t chunk_bytes = DEFAULT_CHUNK_BYTES) {
+        path_ = path;
+        chunk_bytes_ = chunk_bytes;
+        const std::string binary_suffix = ".btrace";
+        binary_ = path.size() >= binary_suffix.size() &&
+                  path.compare(path.size() - binary_suffix.size(), binary_suffix.size(), binary_suffix) == 0;
+
+        if (binary_) {
+            MappedFile file;
+            BinaryTraceView view;
+            std::string error;
+            if (!file.map(path) || !openBinaryTrace(file.data(), file.size(), view, error)) {
+                std::cerr << "ERROR: Cannot open .btrace for streaming: " << path << " " << error << "\n";
+                return false;
+            }
+            runMeta.profile = view.profile;
+            runMeta.N = static_cast<int>(view.N);
+            runMeta.seed = static_cast<int>(view.seed);
+        } else {
+            std::ifstream in(path);
+            std::string header;
+            if (!in.is_open() || !std::getline(in, header)) {
+                std::cerr << "ERROR: Cannot open trace file: " << path << "\n";
+                return false;
+            }
+            header_bytes_ = header.size() + 1;
+            if (!mapped_trace_detail::parse_header(header, runMeta))
+                return false;
+        }
+        std::cout << "Streaming trace: " << runMeta.profile << " N=" << runMeta.N << " seed=" << runMeta.seed
+                  << " in " << (chunk_bytes_ >> 20) << " MB chunks\n";
+        return true;
+    }
+
+    // One full pass: calls f(const std::vector<OperationRef> &) per chunk, in
+    // trace order, on the calling thread. Returns false on a parse error.
+    template<typename F>
+    bool for_each_chunk(F &&f) const {
+        Queue queue;
+        std::thread reader([this, &queue] {
+            run_on_helper_cpus();
+            if (binary_)
+                read_binary(queue);
+            else
+                read_text(queue);
+        });
+
+        while (Chunk *chunk = queue.pop_full()) {
+            f(static_cast<const std::vector<OperationRef> &>(chunk->ops));
+            queue.push_empty(chunk);
+        }
+        reader.join();
+        if (!queue.error.empty())
+            std::cerr << "ERROR: " << path_ << ": " << queue.error << "\n";
+        return queue.error.empty();
+    }
+
+private:
+    // Keys point into bytes (text), into the mapping (.btrace), or into
+    // normalized for text keys whose words had to be re-joined.
+    struct Chunk {
+        std::vector<char> bytes;
+        std::deque<std::string> normalized;
+        std::vector<OperationRef> ops;
+    };
+
+    // Two chunks cycle between an empty list (reader) and a full list (replay).
+    struct Queue {
+        Chunk slots[2];
+        std::deque<Chunk *> empty{&slots[0], &slots[1]};
+        std::deque<Chunk *> full;
+        bool done = false;
+        std::string error;
+        std::mutex m;
+        std::condition_variable cv;
+
+        Chunk *pop_empty() {
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, [this] { return !empty.empty(); });
+            Chunk *c = empty.front();
+            empty.pop_front();
+            return c;
+        }
+        void push_empty(Chunk *c) {
+            { std::lock_guard<std::mutex> lock(m); empty.push_back(c); }
+            cv.notify_all();
+        }
+        // nullptr once the reader is done and every chunk has been handed out.
+        Chunk *pop_full() {
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, [this] { return !full.empty() || done; });
+            if (full.empty())
+                return nullptr;
+            Chunk *c = full.front();
+            full.pop_front();
+            return c;
+        }
+        void push_full(Chunk *c) {
+            { std::lock_guard<std::mutex> lock(m); full.push_back(c); }
+            cv.notify_all();
+        }
+        void finish(std::string why = "") {
+            { std::lock_guard<std::mutex> lock(m); done = true; error = std::move(why); }
+            cv.notify_all();
+        }
+    };
+
+    void read_text(Queue &queue) const {
+        const int fd = ::open(path_.c_str(), O_RDONLY);
+        if (fd < 0) {
+            queue.finish("cannot open");
+            return;
+        }
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        ::lseek(fd, static_cast<off_t>(header_bytes_), SEEK_SET);
+
+        std::string carry;           // partial last line of the previous read
+        std::size_t line_base = 1;   // header is line 1
+        bool eof = false;
+        while (!eof) {
+            Chunk *chunk = queue.pop_empty();
+            chunk->bytes.resize(chunk_bytes_);
+            chunk->normalized.clear();
+            chunk->ops.clear();
+
+            std::memcpy(chunk->bytes.data(), carry.data(), carry.size());
+            std::size_t filled = carry.size();
+            while (filled < chunk_bytes_) {
+                const ssize_t n = ::read(fd, chunk->bytes.data() + filled, chunk_bytes_ - filled);
+                if (n < 0) {
+                    ::close(fd);
+                    queue.finish("read failed");
+                    return;
+                }
+                if (n == 0) {
+                    eof = true;
+                    break;
+                }
+                filled += static_cast<std::size_t>(n);
+            }
+
+            const char *begin = chunk->bytes.data();
+            const char *end = begin + filled;
+            if (!eof) {
+                const char *last_nl = static_cast<const char *>(::memrchr(begin, '\n', filled));
+                if (last_nl == nullptr) {
+                    ::close(fd);
+                    queue.finish("line " + std::to_string(line_base + 1) + " is longer than a chunk");
+                    return;
+                }
+                carry.assign(last_nl + 1, end);
+                end = last_nl + 1;
+            }
+
+            mapped_trace_detail::ParseStatus status;
+            mapped_trace_detail::parse_lines(begin, end, status, [&](OpCode tag, std::string_view key) {
+                if (key.data() < begin || key.data() >= end) {
+                    chunk->normalized.emplace_back(key);
+                    key = chunk->normalized.back();
+                }
+                chunk->ops.emplace_back(tag, key);
+            });
+            if (status.error_line != 0) {
+                ::close(fd);
+                queue.finish("Line " + std::to_string(line_base + status.error_line) + ": " + status.error);
+                return;
+            }
+            line_base += status.lines;
+            queue.push_full(chunk);
+        }
+        ::close(fd);
+        queue.finish();
+    }
+
+    void read_binary(Queue &queue) const {
+        MappedFile file;
+        BinaryTraceView view;
+        std::string error;
+        if (!file.map(path_) || !openBinaryTrace(file.data(), file.size(), view, error)) {
+            queue.finish("cannot open .btrace " + error);
+            return;
+        }
+
+        // Ops reference the mapped dictionary, which stays mapped for the pass.
+        const std::size_t ops_per_chunk = std::max<std::size_t>(chunk_bytes_ / sizeof(OperationRef), 1);
+        Chunk *chunk = queue.pop_empty();
+        chunk->ops.clear();
+        const bool ok = decodeBinaryTraceOps(view, [&](char op, std::uint64_t keyId) {
+            OpCode tag = OpCode::Insert;
+            opcodeFromLetter(op, tag);
+            chunk->ops.emplace_back(tag, view.key(keyId));
+            if (chunk->ops.size() == ops_per_chunk) {
+                queue.push_full(chunk);
+                chunk = queue.pop_empty();
+                chunk->ops.clear();
+            }
+        });
+        if (!chunk->ops.empty())
+            queue.push_full(chunk);
+        else
+            queue.push_empty(chunk);
+
+        // The replay thread may still be using the last chunk; it holds views
+        // into the mapping, so wait for both slots to come back before unmapping.
+        queue.pop_empty();
+        queue.pop_empty();
+        queue.finish(ok ? "" : "corrupt .btrace op stream");
+    }
+
+    std::string path_;
+    std::size_t chunk_bytes_ = DEFAULT_CHUNK_BYTES;
+    std::size_t header_bytes_ = 0;
+    bool binary_ = false;
+};
@@ -0,0 +1,434 @@
+//
+// SweepConfig.h - Declarative parameter sweep for the LRU harness
+//
+// Every swept parameter is a list; the harness replays each trace under the
+// cross product of implementation x probe type x compaction x trigger rate x target load
+// factor x hash policy. Parameters come from command-line flags or from a
+// config file of the same flags, one per line without the leading dashes:
+//
+//     # trigger-rate sweep, double probing only
+//     probe       double
+//     trigger     0.80,0.85,0.90,0.95
+//     hash        polynomial,siphash
+//     out         trigger_sweep.csv
+//
+// Later flags override earlier ones, so `--config f --trials 3` works.
+//
+
+#pragma once
+#include <algorithm>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../TableSizes.hpp"
+#include "TableRegistry.h"
+#include "TrialStatistics.h"
+#include "RegressionGate.h"
+#include "OpenLoopReplay.h"
+
+struct SweepConfig {
+    // inputs and outputs
+    std::string trace_dir = "../traceFiles";
+    std::string profile = "lru_profile";
+    std::string csv_name = "lru_profile.csv";  // written under ../csvs
+
+    // swept parameters
+    std::vector<std::string> implementations{"hash_map"};
+    std::vector<HashTableDictionary::PROBE_TYPE> probe_types{HashTableDictionary::SINGLE, HashTableDictionary::DOUBLE};
+    std::vector<bool> compaction{true};
+    std::vector<double> trigger_rates{0.95};
+    std::vector<double> load_factors{0.0};
+    std::vector<HashTableDictionary::HASH_POLICY> hash_policies{HashTableDictionary::POLYNOMIAL};
+    int hash_seed = -1;  // --hash-seed S; -1 = each trace's own seed
+    TrialPolicy trial_policy;
+    bool max_trials_given = false;
+
+    // how each job runs
+    bool streaming = false;             // --stream
+    unsigned concurrency = 1;           // --jobs K
+    unsigned latency_sample_every = 0;  // --latency K
+    unsigned window_ops = 0;            // --window K
+    std::vector<double> open_loop_rates;                    // --rate LIST
+    ArrivalProcess arrivals = ArrivalProcess::Constant;     // --arrivals
+    bool collect_perf = false;          // --perf
+    bool interleave = false;            // --interleave
+    bool cold_cache = false;            // --cold
+    bool fork_trials = false;           // --fork
+    bool memory = false;                // --memory
+    bool prefetch = false;              // --prefetch
+    bool batch_hash = false;            // --batch-hash
+    std::string trace_events_path;      // --trace-events FILE
+
+    // regression gate
+    std::string baseline_path;        // --baseline FILE
+    std::string write_baseline_path;  // --write-baseline FILE
+    RegressionTolerance tolerance;
+
+    // The cross product, implementation then probe type outermost. The
+    // trigger rate only varies runs that compact, and baselines without
+    // probing or compaction only vary by load factor.
+    std::vector<TableConfig> table_configs() const {
+        std::vector<TableConfig> configs;
+        for (const auto &name: implementations) {
+            const TableImplementation *impl = find_table_implementation(name);
+            if (!impl->tunable) {
+                for (double load: load_factors) {
+                    std::ostringstream label;
+                    label << impl->description;
+                    if (load > 0.0)
+                        label << " (load " << load << ")";
+                    configs.push_back({name, name, label.str(), HashTableDictionary::SINGLE, false,
+                                       trigger_rates.front(), HashTableDictionary::POLYNOMIAL, load});
+                }
+                continue;
+            }
+            for (auto probe: probe_types) {
+                for (bool compact: compaction) {
+                    const std::vector<double> rates = compact ? trigger_rates : std::vector<double>{trigger_rates.front()};
+                    for (double rate: rates) {
+                        for (double load: load_factors) {
+                            for (auto policy: hash_policies) {
+                                std::ostringstream label;
+                                label << (probe == HashTableDictionary::SINGLE ? "Single" : "Double") << " Probing ("
+                                      << "compaction " << (compact ? "ON" : "OFF");
+                                if (compact)
+                                    label << " @ " << rate;
+                                if (load > 0.0)
+                                    label << ", load " << load;
+                                label << ", " << hash_policy_name(policy) << " hash)";
+                                configs.push_back({name, name + (probe == HashTableDictionary::SINGLE ? "_single" : "_double"),
+                                                   label.str(), probe, compact, rate, policy, load});
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return configs;
+    }
+
+    // Applies one flag (without dashes) and its value; returns false with a
+    // message on cerr if either is not understood.
+    bool apply(const std::string &key, const std::string &value) {
+        bool ok = true;
+        std::vector<double> values;
+        if (key == "trace-dir") {
+            trace_dir = value;
+        } else if (key == "profile") {
+            profile = value;
+        } else if (key == "out") {
+            csv_name = value;
+        } else if (key == "impl") {
+            implementations.clear();
+            for (const auto &item: split(value)) {
+                if (find_table_implementation(item) != nullptr) implementations.push_back(item);
+                else ok = false;
+            }
+        } else if (key == "probe") {
+            probe_types.clear();
+            for (const auto &item: split(value)) {
+                if (item == "single") probe_types.push_back(HashTableDictionary::SINGLE);
+                else if (item == "double") probe_types.push_back(HashTableDictionary::DOUBLE);
+                else ok = false;
+            }
+        } else if (key == "compaction") {
+            compaction.clear();
+            for (const auto &item: split(value)) {
+                if (item == "on") compaction.push_back(true);
+                else if (item == "off") compaction.push_back(false);
+                else ok = false;
+            }
+        } else if (key == "trigger") {
+            ok = parse_doubles(value, trigger_rates, 0.0, 1.0);
+        } else if (key == "load-factor") {
+            ok = parse_doubles(value, load_factors, 0.0, 1.0);
+        } else if (key == "hash") {
+            hash_policies.clear();
+            for (const auto &item: split(value)) {
+                if (item == "polynomial") hash_policies.push_back(HashTableDictionary::POLYNOMIAL);
+                else if (item == "siphash") hash_policies.push_back(HashTableDictionary::SIPHASH);
+                else if (item == "fast") hash_policies.push_back(HashTableDictionary::FAST);
+                else ok = false;
+            }
+        } else if (key == "hash-seed") {
+            ok = parse_unsigned(value, hash_seed);
+        } else if (key == "trials") {
+            ok = parse_unsigned(value, trial_policy.min_trials) && trial_policy.min_trials > 0;
+        } else if (key == "max-trials") {
+            ok = parse_unsigned(value, trial_policy.max_trials) && trial_policy.max_trials > 0;
+            max_trials_given = true;
+        } else if (key == "ci-target") {
+            ok = parse_doubles(value, values, 0.0, 1.0) && values.size() == 1;
+            trial_policy.ci_target = ok ? values.front() : 0.0;
+        } else if (key == "time-budget") {
+            ok = parse_doubles(value, values, 0.0, 1e9) && values.size() == 1;
+            trial_policy.time_budget_s = ok ? values.front() : 0.0;
+        } else if (key == "jobs") {
+            int jobs = 0;
+            ok = parse_unsigned(value, jobs);
+            concurrency = static_cast<unsigned>(jobs);
+        } else if (key == "latency") {
+            int every = 0;
+            ok = parse_unsigned(value, every);
+            latency_sample_every = static_cast<unsigned>(every);
+        } else if (key == "window") {
+            int ops = 0;
+            ok = parse_unsigned(value, ops);
+            window_ops = static_cast<unsigned>(ops);
+        } else if (key == "rate") {
+            ok = parse_doubles(value, open_loop_rates, 0.0, 1e12);
+        } else if (key == "arrivals") {
+            if (value == "constant") arrivals = ArrivalProcess::Constant;
+            else if (value == "poisson") arrivals = ArrivalProcess::Poisson;
+            else ok = false;
+        } else if (key == "stream") {
+            streaming = true;
+        } else if (key == "perf") {
+            collect_perf = true;
+        } else if (key == "interleave") {
+            interleave = true;
+        } else if (key == "cold") {
+            cold_cache = true;
+        } else if (key == "fork") {
+            fork_trials = true;
+        } else if (key == "memory") {
+            memory = true;
+        } else if (key == "prefetch") {
+            prefetch = true;
+        } else if (key == "batch-hash") {
+            batch_hash = true;
+        } else if (key == "trace-events") {
+            trace_events_path = value;
+        } else if (key == "baseline") {
+            baseline_path = value;
+        } else if (key == "write-baseline") {
+            write_baseline_path = value;
+        } else if (key == "time-tolerance") {
+            ok = parse_doubles(value, values, -1.0, 1e9) && values.size() == 1 && values.front() >= 0.0;
+            tolerance.time = ok ? values.front() : tolerance.time;
+        } else if (key == "structural-tolerance") {
+            ok = parse_doubles(value, values, -1.0, 1e9) && values.size() == 1 && values.front() >= 0.0;
+            tolerance.structural = ok ? values.front() : tolerance.structural;
+        } else if (key == "config") {
+            ok = load_file(value);
+        }
+
+        if (!ok || implementations.empty() || probe_types.empty() || compaction.empty() || hash_policies.empty()) {
+            std::cerr << "ERROR: Bad value for " << key << ": '" << value << "'\n";
+            return false;
+        }
+        return true;
+    }
+
+    static bool takes_value(const std::string &key) {
+        return key != "stream" && key != "perf" && key != "interleave" && key != "cold" && key != "fork"
+               && key != "memory" && key != "prefetch" && key != "batch-hash";
+    }
+
+    static bool is_option(const std::string &key) {
+        for (const char *name: {"trace-dir", "profile", "out", "impl", "probe", "compaction", "trigger", "load-factor",
+                                "hash", "hash-seed", "trials", "max-trials", "ci-target", "time-budget", "jobs", "latency",
+                                "window", "rate", "arrivals", "stream", "perf", "interleave", "cold", "fork", "memory",
+                                "prefetch", "batch-hash", "trace-events", "baseline", "write-baseline", "time-tolerance",
+                                "structural-tolerance", "config"}) {
+            if (key == name)
+                return true;
+        }
+        return false;
+    }
+
+    bool load_file(const std::string &path) {
+        std::ifstream in(path);
+        if (!in.is_open()) {
+            std::cerr << "ERROR: Cannot open sweep config: " << path << "\n";
+            return false;
+        }
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream fields(line);
+            std::string key, value;
+            if (!(fields >> key) || key[0] == '#')
+                continue;
+            if (!is_option(key)) {
+                std::cerr << "ERROR: " << path << ": unknown option '" << key << "'\n";
+                return false;
+            }
+            if (takes_value(key) && !(fields >> value)) {
+                std::cerr << "ERROR: " << path << ": '" << key << "' needs a value\n";
+                return false;
+            }
+            if (!apply(key, value))
+                return false;
+        }
+        return true;
+    }
+
+    // Parses --key value / --flag arguments in order.
+    bool parse_args(int argc, char *argv[]) {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg.rfind("--", 0) != 0) {
+                std::cerr << "ERROR: Unexpected argument '" << arg << "'\n";
+                return false;
+            }
+            const std::string key = arg.substr(2);
+            if (!is_option(key)) {
+                std::cerr << "ERROR: Unknown option '" << arg << "'\n";
+                return false;
+            }
+            std::string value;
+            if (takes_value(key)) {
+                if (i + 1 >= argc) {
+                    std::cerr << "ERROR: " << arg << " needs a value\n";
+                    return false;
+                }
+                value = argv[++i];
+            }
+            if (!apply(key, value))
+                return false;
+        }
+
+        // Adaptive repetition needs room above the minimum; a fixed count
+        // (no --ci-target) runs exactly --trials.
+        if (!max_trials_given)
+            trial_policy.max_trials = trial_policy.ci_target > 0.0 ? std::max(trial_policy.min_trials, 50)
+                                                                   : trial_policy.min_trials;
+        if (trial_policy.max_trials < trial_policy.min_trials) {
+            std::cerr << "ERROR: --max-trials is below --trials\n";
+            return false;
+        }
+        // The counters follow the parent thread, not a forked child.
+        if (fork_trials && collect_perf) {
+            std::cerr << "ERROR: --perf cannot be combined with --fork\n";
+            return false;
+        }
+        // A forked child gets only the forking thread; a lock another worker
+        // held at that moment (e.g. the allocator's) would never be released.
+        if (fork_trials && concurrency != 1) {
+            std::cerr << "ERROR: --fork cannot be combined with --jobs other than 1\n";
+            return false;
+        }
+        // Peak RSS is process-wide, so concurrent jobs or a streaming
+        // reader's buffers would be charged to the table being measured.
+        if (memory && (streaming || concurrency != 1)) {
+            std::cerr << "ERROR: --memory cannot be combined with --stream or --jobs other than 1\n";
+            return false;
+        }
+        return compaction_can_settle();
+    }
+
+    // An LRU trace holds about N keys once warm, so a compacting table sits at
+    // N / M after every compaction; at or above the trigger it would compact
+    // again on the next insert, forever.
+    bool compaction_can_settle() const {
+        const bool compacts = std::find(compaction.begin(), compaction.end(), true) != compaction.end()
+                              && std::find(implementations.begin(), implementations.end(), "hash_map") != implementations.end();
+        if (!compacts)
+            return true;
+        double section_4_4_load = DEFAULT_LOAD_FACTOR;
+        for (const auto &[N, M]: N_to_M_mapping)
+            section_4_4_load = std::max(section_4_4_load, static_cast<double>(N) / M);
+        for (double load: load_factors) {
+            const double steady = load > 0.0 ? load : section_4_4_load;
+            for (double rate: trigger_rates) {
+                if (steady >= rate) {
+                    std::cerr << "ERROR: compaction trigger " << rate << " is not above the steady-state load "
+                              << steady << (load > 0.0 ? "" : " of the default table sizes")
+                              << "; lower --load-factor or raise --trigger\n";
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    static void print_usage(const char *program) {
+        std::cerr << "Usage: " << program << " [options]\n"
+                  << "  --trace-dir DIR      traces to replay (default ../traceFiles)\n"
+                  << "  --profile NAME       trace file prefix (default lru_profile)\n"
+                  << "  --out FILE           CSV name under ../csvs (default lru_profile.csv)\n"
+                  << "  --impl LIST          table implementations (default hash_map):\n";
+        for (const auto &impl: TABLE_IMPLEMENTATIONS)
+            std::cerr << "                         " << impl.name << " - " << impl.description << "\n";
+        std::cerr << "  --probe LIST         single,double (hash_map)\n"
+                  << "  --compaction LIST    on,off (hash_map, default on)\n"
+                  << "  --trigger LIST       compaction trigger rates (default 0.95)\n"
+                  << "  --load-factor LIST   target load factors; M = next prime >= N / load\n"
+                  << "                       (default: Section 4.4 size, load 0.8 for other N)\n"
+                  << "  --hash LIST          polynomial,siphash,fast (hash_map, default polynomial)\n"
+                  << "  --hash-seed S        key siphash/fast from S (default: the trace's seed)\n"
+                  << "  --batch-hash         hash 64 keys at a time in the timed replay (hash_map;\n"
+                  << "                       AVX2 for polynomial)\n"
+                  << "  --trials K           timed trials per run, median reported (default 7)\n"
+                  << "  --ci-target F        add trials until the 95% CI of the median is within\n"
+                  << "                       +/-F of it (e.g. 0.01), up to --max-trials (default 50)\n"
+                  << "  --time-budget S      stop adding trials after S seconds of timed replay\n"
+                  << "  --interleave         alternate trials across configurations of a trace\n"
+                  << "  --cold               evict the CPU caches before each trial\n"
+                  << "  --fork               run each trial in a forked child, which starts from a\n"
+                  << "                       copy-on-write copy of the parent's heap (--jobs 1 only)\n"
+                  << "  --jobs K             concurrent jobs, 0 = one per allowed CPU (default 1)\n"
+                  << "  --latency K          time every K-th op in an extra pass\n"
+                  << "  --window K           per-window time series of K ops in an extra pass,\n"
+                  << "                       written to <out>_windows.csv\n"
+                  << "  --rate LIST          open-loop passes at these arrival rates (ops/s);\n"
+                  << "                       response times from intended start, written to\n"
+                  << "                       <out>_openloop.csv\n"
+                  << "  --arrivals KIND      constant or poisson (default constant)\n"
+                  << "  --perf               hardware counters per op\n"
+                  << "  --memory             peak RSS, heap and bytes per key from an extra pass\n"
+                  << "  --stream             replay traces from disk in bounded memory\n"
+                  << "  --prefetch           load the next trace on a spare core while this one is\n"
+                  << "                       timed (shares the LLC and memory bandwidth with it)\n"
+                  << "  --trace-events F     write a Chrome trace-event timeline of loads, warm-ups,\n"
+                  << "                       trials, clear() and compactTable() (open in Perfetto)\n"
+                  << "  --write-baseline F   save timing and structural metrics with the build\n"
+                  << "                       environment as JSON\n"
+                  << "  --baseline F         compare against a saved baseline; exit 2 on regression\n"
+                  << "  --time-tolerance X   allowed median slowdown, same CPU only (default 0.10)\n"
+                  << "  --structural-tolerance X\n"
+                  << "                       allowed increase in total_probes, compactions and\n"
+                  << "                       max_in_table (default 0); decreases never fail\n"
+                  << "  --config FILE        read the options above from FILE\n";
+    }
+
+private:
+    static std::vector<std::string> split(const std::string &list) {
+        std::vector<std::string> items;
+        std::istringstream in(list);
+        std::string item;
+        while (std::getline(in, item, ','))
+            if (!item.empty())
+                items.push_back(item);
+        return items;
+    }
+
+    // Values must lie in (lo, hi].
+    static bool parse_doubles(const std::string &list, std::vector<double> &out, double lo, double hi) {
+        out.clear();
+        for (const auto &item: split(list)) {
+            std::size_t used = 0;
+            double v = 0;
+            try {
+                v = std::stod(item, &used);
+            } catch (const std::exception &) {
+                return false;
+            }
+            if (used != item.size() || v <= lo || v > hi)
+                return false;
+            out.push_back(v);
+        }
+        return !out.empty();
+    }
+
+    static bool parse_unsigned(const std::string &s, int &out) {
+        if (s.empty() || s.find_first_not_of("0123456789") != std::string::npos || s.size() > 9)
+            return false;
+        out = std::stoi(s);
+        return true;
+    }
+};
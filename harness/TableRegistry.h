@@ -0,0 +1,96 @@
+//
+// TableRegistry.h - Table implementations the harness can replay against
+//
+// Implementations are selected by name. with_table() builds the named table
+// and hands it to a generic callback, so run_trace_ops() is instantiated for
+// each concrete type and replay never goes through a virtual call. To add a
+// backend, give it insert / remove / clear / csvStats / counters (see BaselineTables.h)
+// and add one entry to TABLE_IMPLEMENTATIONS and one case to with_table().
+//
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "BaselineTables.h"
+#include "../HashTableDictionary.hpp"
+
+// One point of the sweep: a table to build for every trace.
+struct TableConfig {
+    std::string implementation;  // registry name
+    std::string impl;            // CSV impl column
+    std::string label;
+    HashTableDictionary::PROBE_TYPE probeType;
+    bool compaction;
+    double compactionRate;
+    HashTableDictionary::HASH_POLICY hashPolicy;
+    double targetLoadFactor;  // 0 = table size M from Section 4.4
+};
+
+inline const char *hash_policy_name(HashTableDictionary::HASH_POLICY policy) {
+    switch (policy) {
+        case HashTableDictionary::SIPHASH: return "siphash";
+        case HashTableDictionary::FAST: return "fast";
+        default: return "polynomial";
+    }
+}
+
+struct TableImplementation {
+    const char *name;
+    const char *description;
+    bool tunable;  // whether probe type, compaction and hash policy apply
+};
+
+inline const std::vector<TableImplementation> TABLE_IMPLEMENTATIONS = {
+    {"hash_map", "HashTableDictionary, open addressing with tombstones", true},
+    {"unordered_set", "std::unordered_set<std::string>, separate chaining", false},
+    {"sorted_vector", "sorted std::vector<std::string>, binary search, O(n) updates", false},
+};
+
+inline const TableImplementation *find_table_implementation(const std::string &name) {
+    for (const auto &impl: TABLE_IMPLEMENTATIONS) {
+        if (name == impl.name)
+            return &impl;
+    }
+    return nullptr;
+}
+
+// Expands a run's hash seed into the 128-bit key of the keyed policies
+// (SplitMix64), so a siphash or fast run is reproducible from its CSV row.
+inline void hash_keys_for_seed(std::uint64_t seed, std::uint64_t &k0, std::uint64_t &k1) {
+    auto next = [&seed] {
+        std::uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    };
+    k0 = next();
+    k1 = next();
+}
+
+// Builds config's implementation with table size M, its keyed hash (if any)
+// seeded from hash_seed, and calls f(table). Returns false for an unknown
+// implementation.
+template<typename F>
+bool with_table(const TableConfig &config, std::size_t table_size, std::uint64_t hash_seed, F &&f) {
+    if (config.implementation == "hash_map") {
+        HashTableDictionary table(table_size, config.probeType, config.compaction, config.compactionRate,
+                                  config.hashPolicy);
+        if (config.hashPolicy != HashTableDictionary::POLYNOMIAL) {
+            std::uint64_t k0 = 0, k1 = 0;
+            hash_keys_for_seed(hash_seed, k0, k1);
+            table.reseedHash(k0, k1);
+        }
+        f(table);
+    } else if (config.implementation == "unordered_set") {
+        UnorderedSetTable table(table_size);
+        f(table);
+    } else if (config.implementation == "sorted_vector") {
+        SortedVectorTable table(table_size);
+        f(table);
+    } else {
+        return false;
+    }
+    return true;
+}
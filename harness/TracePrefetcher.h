@@ -0,0 +1,119 @@
+//
+// TracePrefetcher.h - Load the next trace while the current one is measured
+//
+// Without it a sweep alternates between loading a trace on one core and
+// replaying it, and the large traces spend seconds in parsing while every
+// other core idles. The prefetcher owns one loader thread pinned to the last
+// core the process may run on; when the first job of trace i starts, trace
+// i+1 is queued for loading there. A job that reaches a trace still being loaded waits for it, so the
+// order of results and the replay itself are unchanged.
+//
+// The loader's core is taken out of the calling thread's affinity mask, so a
+// single unpinned worker never shares it, and the loader only starts when a
+// core is free beyond the timing workers. It still shares the last-level
+// cache and memory bandwidth with them, so it is opt-in (--prefetch).
+//
+
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "../TraceEvents.hpp"
+
+class TracePrefetcher {
+public:
+    // `workers` timing threads run alongside. When not `wanted`, or with no
+    // core to spare, the prefetcher stays disabled and prefetch() does nothing.
+    TracePrefetcher(bool wanted, unsigned workers) {
+        // The cores of this process's cpuset, which may be fewer than the
+        // machine's (taskset, containers).
+        cpu_set_t allowed;
+        if (!wanted || sched_getaffinity(0, sizeof(allowed), &allowed) != 0
+            || workers >= static_cast<unsigned>(CPU_COUNT(&allowed)))
+            return;
+        for (int cpu = CPU_SETSIZE - 1; cpu >= 0; --cpu) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                core_ = static_cast<unsigned>(cpu);
+                break;
+            }
+        }
+        reserve_core(allowed);
+        loader_ = std::thread([this] {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(core_, &set);
+            if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+                std::cerr << "WARNING: could not pin the trace loader to core " << core_ << "\n";
+            nameTraceThread("trace loader");
+            load_loop();
+        });
+    }
+
+    ~TracePrefetcher() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        if (loader_.joinable())
+            loader_.join();
+    }
+
+    TracePrefetcher(const TracePrefetcher &) = delete;
+    TracePrefetcher &operator=(const TracePrefetcher &) = delete;
+
+    bool enabled() const { return loader_.joinable(); }
+    unsigned core() const { return core_; }
+
+    // Queues `load` for the loader thread. It must be safe to run while the
+    // jobs of earlier traces replay and idempotent with the job's own load.
+    // Threads it starts inherit the loader's single core, so it should not
+    // fan out (load_trace_mmap with num_threads = 1).
+    void prefetch(std::function<void()> load) {
+        if (!enabled())
+            return;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_.push_back(std::move(load));
+        }
+        wake_.notify_one();
+    }
+
+private:
+    // Keeps the calling thread, and the threads it starts from now on, off
+    // the loader's core.
+    void reserve_core(cpu_set_t set) const {
+        CPU_CLR(core_, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) != 0)
+            std::cerr << "WARNING: could not reserve core " << core_ << " for the trace loader\n";
+    }
+
+    void load_loop() {
+        while (true) {
+            std::function<void()> load;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+                if (stopping_)
+                    return;
+                load = std::move(pending_.front());
+                pending_.pop_front();
+            }
+            load();
+        }
+    }
+
+    unsigned core_ = 0;
+    std::thread loader_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<std::function<void()>> pending_;
+    bool stopping_ = false;
+};
@@ -0,0 +1,145 @@
+//
+// TrialIsolation.h - Cold-cache and forked trials
+//
+// By default every timed trial reuses the same table after clear(), so it
+// starts with warm caches and an allocator already holding the previous
+// trial's freed strings. CacheEvictor streams a buffer larger than the last
+// level cache before a trial, so the replay starts with the table and the
+// keys out of cache. run_forked() runs a trial in a child process; the
+// harness builds and warms up a new table there, so no trial inherits a
+// table from the warm-up or an earlier trial, and nothing a trial allocates
+// or frees reaches the next. The child's heap is still a copy-on-write copy
+// of the parent's, allocator state included, not a fresh one.
+//
+
+#pragma once
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// ============================================================================
+// Cache eviction
+// ============================================================================
+class CacheEvictor {
+public:
+    // 0 = twice the last level cache
+    explicit CacheEvictor(std::size_t bytes = 0)
+        : buffer_(bytes != 0 ? bytes : 2 * last_level_cache_bytes(), 1) {}
+
+    // Writes then reads every cache line of the buffer, which pushes
+    // everything else out of the caches (and dirty lines back to memory).
+    void evict() {
+        for (std::size_t i = 0; i < buffer_.size(); i += LINE)
+            ++buffer_[i];
+        unsigned char sum = 0;
+        for (std::size_t i = 0; i < buffer_.size(); i += LINE)
+            sum ^= buffer_[i];
+        sink_ = sum;
+    }
+
+    std::size_t bytes() const { return buffer_.size(); }
+
+    // Largest data cache sysconf reports, or 32 MiB if it reports none.
+    static std::size_t last_level_cache_bytes() {
+        long bytes = 0;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+        bytes = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+#ifdef _SC_LEVEL2_CACHE_SIZE
+        if (bytes <= 0)
+            bytes = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+        return bytes > 0 ? static_cast<std::size_t>(bytes) : std::size_t{32} << 20;
+    }
+
+private:
+    static constexpr std::size_t LINE = 64;
+
+    std::vector<unsigned char> buffer_;
+    volatile unsigned char sink_ = 0;
+};
+
+// One evictor per worker thread; interleaved sessions on a thread share it.
+inline CacheEvictor &thread_cache_evictor() {
+    thread_local CacheEvictor evictor;
+    return evictor;
+}
+
+// ============================================================================
+// Forked trials
+// ============================================================================
+// Runs trial() in a child process and returns the string it produced, or
+// nothing (with a message on cerr) if the child could not be started or did
+// not exit cleanly. The child only replays and reports through a pipe; it
+// leaves with _exit(), so it never runs the parent's destructors or atexit
+// handlers. The child has only the calling thread, and any lock another
+// thread held at the fork stays locked there, so the caller must be the
+// process's only thread (--fork requires --jobs 1).
+template<typename F>
+std::optional<std::string> run_forked(F &&trial) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        std::perror("pipe");
+        return std::nullopt;
+    }
+
+    // Anything still buffered would otherwise be written by both processes.
+    std::cout.flush();
+    std::fflush(nullptr);
+
+    const pid_t pid = fork();
+    if (pid < 0) {
+        std::perror("fork");
+        close(fds[0]);
+        close(fds[1]);
+        return std::nullopt;
+    }
+
+    if (pid == 0) {
+        close(fds[0]);
+        const std::string result = trial();
+        std::size_t written = 0;
+        while (written < result.size()) {
+            const ssize_t n = write(fds[1], result.data() + written, result.size() - written);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                _exit(1);
+            written += static_cast<std::size_t>(n);
+        }
+        close(fds[1]);
+        std::cout.flush();
+        std::fflush(nullptr);
+        _exit(0);
+    }
+
+    close(fds[1]);
+    std::string result;
+    char chunk[4096];
+    for (;;) {
+        const ssize_t n = read(fds[0], chunk, sizeof chunk);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        result.append(chunk, static_cast<std::size_t>(n));
+    }
+    close(fds[0]);
+
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        std::cerr << "ERROR: Forked trial did not exit cleanly (status " << status << ")\n";
+        return std::nullopt;
+    }
+    return result;
+}
@@ -0,0 +1,108 @@
+//
+// TrialStatistics.h - Uncertainty of a set of timed trials
+//
+// The reported time is still the median trial. Its uncertainty is a
+// percentile-bootstrap confidence interval: the trials are resampled with
+// replacement, the median of each resample is taken, and the interval is
+// the middle `confidence` fraction of those medians. The resampling RNG has
+// a fixed seed, so the same trials always give the same interval. Outliers
+// are trials outside Tukey's fences (1.5 IQR beyond the quartiles); they are
+// counted, not dropped, since the median already ignores them.
+//
+
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+struct TrialSummary {
+    std::size_t trials = 0;
+    double median_ns = 0;
+    double ci_low_ns = 0;
+    double ci_high_ns = 0;
+    std::size_t outliers = 0;
+
+    // CI half-width relative to the median (0.01 = +/-1%)
+    double relative_half_width() const {
+        return median_ns > 0 ? (ci_high_ns - ci_low_ns) / 2.0 / median_ns : 0.0;
+    }
+};
+
+namespace trial_statistics_detail {
+
+// Median of a sorted sample, averaging the middle pair for even sizes.
+inline double sorted_median(const std::vector<double> &sorted) {
+    const std::size_t n = sorted.size();
+    return n % 2 == 1 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2.0;
+}
+
+// Linear-interpolated quantile of a sorted sample.
+inline double sorted_quantile(const std::vector<double> &sorted, double q) {
+    const double pos = q * static_cast<double>(sorted.size() - 1);
+    const auto lo = static_cast<std::size_t>(pos);
+    const std::size_t hi = std::min(lo + 1, sorted.size() - 1);
+    return sorted[lo] + (sorted[hi] - sorted[lo]) * (pos - static_cast<double>(lo));
+}
+
+} // namespace trial_statistics_detail
+
+inline TrialSummary summarize_trials(const std::vector<std::int64_t> &trials_ns,
+                                     double confidence = 0.95,
+                                     int resamples = 2000) {
+    using namespace trial_statistics_detail;
+    TrialSummary s;
+    s.trials = trials_ns.size();
+    if (trials_ns.empty())
+        return s;
+
+    std::vector<double> sorted(trials_ns.begin(), trials_ns.end());
+    std::sort(sorted.begin(), sorted.end());
+    s.median_ns = sorted_median(sorted);
+    s.ci_low_ns = s.ci_high_ns = s.median_ns;
+    if (sorted.size() < 3)
+        return s;
+
+    const double q1 = sorted_quantile(sorted, 0.25);
+    const double q3 = sorted_quantile(sorted, 0.75);
+    const double fence = 1.5 * (q3 - q1);
+    s.outliers = static_cast<std::size_t>(std::count_if(sorted.begin(), sorted.end(), [&](double v) {
+        return v < q1 - fence || v > q3 + fence;
+    }));
+
+    std::mt19937_64 rng(0x5eed);
+    std::uniform_int_distribution<std::size_t> pick(0, sorted.size() - 1);
+    std::vector<double> medians(static_cast<std::size_t>(resamples));
+    std::vector<double> resample(sorted.size());
+    for (auto &median: medians) {
+        for (auto &v: resample)
+            v = sorted[pick(rng)];
+        std::sort(resample.begin(), resample.end());
+        median = sorted_median(resample);
+    }
+    std::sort(medians.begin(), medians.end());
+    s.ci_low_ns = sorted_quantile(medians, (1.0 - confidence) / 2.0);
+    s.ci_high_ns = sorted_quantile(medians, 1.0 - (1.0 - confidence) / 2.0);
+    return s;
+}
+
+// When to stop running trials: after min_trials, keep going while the CI is
+// wider than ci_target (relative half-width, 0 = never), up to max_trials and
+// within time_budget_s seconds of timed replay (0 = no budget).
+struct TrialPolicy {
+    int min_trials = 7;
+    int max_trials = 7;
+    double ci_target = 0.0;
+    double time_budget_s = 0.0;
+
+    bool wants_more(const std::vector<std::int64_t> &trials_ns, double spent_s) const {
+        const int done = static_cast<int>(trials_ns.size());
+        if (done < min_trials)
+            return true;
+        if (ci_target <= 0.0 || done >= max_trials)
+            return false;
+        if (time_budget_s > 0.0 && spent_s >= time_budget_s)
+            return false;
+        return summarize_trials(trials_ns).relative_half_width() > ci_target;
+    }
+};
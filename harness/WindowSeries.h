@@ -0,0 +1,113 @@
+//
+// WindowSeries.h - Per-window time series of one replay
+//
+// The replay is cut into windows of K operations. At the end of each window
+// the elapsed time and the table's running counters are sampled, so every
+// row describes that window alone: its throughput, average probes and
+// compactions, plus the occupancy at the window's end. Between compactions
+// the rows show throughput falling as tombstones build up.
+//
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Operation.h"
+#include "../HashTableDictionary.hpp"
+
+struct WindowRow {
+    std::size_t window = 0;        // 0-based
+    std::uint64_t ops_end = 0;     // operations replayed at the end of the window
+    std::uint64_t ops = 0;         // operations in the window
+    std::uint64_t inserts = 0;
+    std::uint64_t erases = 0;
+    std::uint64_t lookups = 0;
+    std::int64_t elapsed_ns = 0;
+    HashTableDictionary::Counters end{};    // counters at the end of the window
+    HashTableDictionary::Counters delta{};  // change over the window
+
+    // Column names follow the run CSV, so the LRU plotting app reads these rows
+    // as they are (it switches its x axis to ops_end when the column exists).
+    static std::string csv_header() {
+        return "window,ops_end,elapsed_ms,ops_total,inserts,erases,lookups,ops_per_sec,average_probes,"
+               "load_factor_pct,eff_load_factor_pct,tombstones_pct,full_scans,compactions";
+    }
+
+    std::string to_csv() const {
+        std::ostringstream os;
+        const double ms = static_cast<double>(elapsed_ns) / 1e6;
+        const double table = end.tableSize > 0 ? static_cast<double>(end.tableSize) : 1.0;
+        const std::int64_t table_ops = delta.inserts + delta.deletes + delta.lookups;
+        os << window << ',' << ops_end << ',' << ms << ',' << ops << ',' << inserts << ',' << erases << ','
+           << lookups << ',' << (elapsed_ns > 0 ? static_cast<double>(ops) / (ms / 1e3) : 0.0) << ',';
+        if (delta.totalProbes > 0 && table_ops > 0)
+            os << static_cast<double>(delta.totalProbes) / static_cast<double>(table_ops);
+        os << ',' << 100.0 * static_cast<double>(end.active) / table
+           << ',' << 100.0 * static_cast<double>(end.active + end.tombstones) / table
+           << ',' << 100.0 * static_cast<double>(end.tombstones) / table
+           << ',' << delta.fullScans << ',' << delta.compactions;
+        return os.str();
+    }
+};
+
+// Call start() before the replay, op() after every operation and finish()
+// after the last one.
+class WindowRecorder {
+public:
+    explicit WindowRecorder(std::uint64_t window_ops) : window_ops_(window_ops) {}
+
+    void start(const HashTableDictionary::Counters &counters) {
+        rows_.clear();
+        previous_ = counters;
+        ops_ = 0;
+        current_ = WindowRow();
+        window_start_ = clock::now();
+    }
+
+    template<typename Table>
+    void op(OpCode tag, const Table &table) {
+        ++ops_;
+        ++current_.ops;
+        ++(tag == OpCode::Insert ? current_.inserts : tag == OpCode::Erase ? current_.erases : current_.lookups);
+        if (current_.ops == window_ops_)
+            close_window(table.counters());
+    }
+
+    template<typename Table>
+    void finish(const Table &table) {
+        if (current_.ops != 0)
+            close_window(table.counters());
+    }
+
+    const std::vector<WindowRow> &rows() const { return rows_; }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    void close_window(const HashTableDictionary::Counters &now) {
+        const auto t = clock::now();
+        current_.window = rows_.size();
+        current_.ops_end = ops_;
+        current_.elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t - window_start_).count();
+        current_.end = now;
+        current_.delta = {now.tableSize, now.active - previous_.active, now.tombstones - previous_.tombstones,
+                          now.totalProbes - previous_.totalProbes, now.inserts - previous_.inserts,
+                          now.deletes - previous_.deletes, now.lookups - previous_.lookups,
+                          now.fullScans - previous_.fullScans, now.compactions - previous_.compactions};
+        rows_.push_back(current_);
+
+        previous_ = now;
+        current_ = WindowRow();
+        window_start_ = clock::now();  // sampling cost stays out of the next window
+    }
+
+    std::uint64_t window_ops_;
+    std::uint64_t ops_ = 0;
+    WindowRow current_;
+    HashTableDictionary::Counters previous_{};
+    clock::time_point window_start_;
+    std::vector<WindowRow> rows_;
+};
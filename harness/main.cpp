@@ -11,216 +11,627 @@
 #include <iostream>
 #include <chrono>
 #include <map>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <optional>
+#include <cmath>
+#include <memory>
+#include <limits>
+#include <type_traits>
 
 #include "Operation.h"
 #include "RunResults.h"
-#include "../HashTableDictionary.hpp"  // Adjust path as needed
+#include "MappedTrace.h"
+#include "StreamingTrace.h"
+#include "BenchmarkScheduler.h"
+#include "PerfCounters.h"
+#include "SweepConfig.h"
+#include "TableRegistry.h"
+#include "TrialStatistics.h"
+#include "WindowSeries.h"
+#include "TrialIsolation.h"
+#include "MemoryAccounting.h"
+#include "OpenLoopReplay.h"
+#include "TracePrefetcher.h"
+#include "../TableSizes.hpp"
+#include "../TraceEvents.hpp"
 
 // ============================================================================
-// Helper: Map N to table size M (from Section 4.4)
+// Visit every operation of a loaded or streamed trace, in order
 // ============================================================================
-// This mapping should come from the provided implementation's main.cpp
-// You'll need to extract this from the HashTableDictionary project
-std::map<int, int> N_to_M_mapping = {
-    {1024,    1279},
-    {2048,    2551},
-    {4096,    5101},
-    {8192,    10273},
-    {16384,   20479},
-    {32768,   40849},
-    {65536,   81931},
-    {131072,  163861},
-    {262144,  327739},
-    {524288,  655243},
-    {1048576, 1310809}
-};
+template<typename Ops, typename F>
+bool for_each_op(const Ops &ops, F &&f) {
+    for (const auto &op: ops)
+        f(op);
+    return true;
+}
 
-int get_table_size_for_N(int N) {
-    auto it = N_to_M_mapping.find(N);
-    if (it != N_to_M_mapping.end()) {
-        return it->second;
+// One pass re-reads the file; returns false if it could not be read or parsed.
+template<typename F>
+bool for_each_op(const StreamingTrace &trace, F &&f) {
+    return trace.for_each_chunk([&f](const std::vector<OperationRef> &chunk) {
+        for (const auto &op: chunk)
+            f(op);
+    });
+}
+
+// Applies one operation to any table the registry can build.
+template<typename Table, typename Op>
+void apply_op(Table &table, const Op &op) {
+    if (op.isInsert()) {
+        table.insert(op.key);
+    } else if (op.isErase()) {
+        table.remove(op.key);
+    } else if (op.isLookup()) {
+        table.member(op.key);
     }
-    std::cerr << "ERROR: No table size mapping found for N=" << N << "\n";
-    std::exit(1);
 }
 
 // ============================================================================
-// Timing function - runs hash table operations and measures time
+// Batched replay (--batch-hash) - keys hashed a batch at a time
 // ============================================================================
-template<typename HashTable>
-RunResult run_trace_ops(HashTable &table,
-                        RunResult &runResult,
-                        const std::vector<Operation> &ops) {
+struct OpBatch {
+    static constexpr std::size_t CAPACITY = 64;
+    std::string_view keys[CAPACITY];
+    OpCode tags[CAPACITY];
+    std::size_t size = 0;
+};
 
-    // Count operations for sanity check
+// Visits the operations up to OpBatch::CAPACITY at a time.
+template<typename Ops, typename F>
+bool for_each_op_batch(const Ops &ops, F &&f) {
+    OpBatch batch;
     for (const auto &op: ops) {
-        if (op.isInsert()) {
-            ++runResult.inserts;
-        } else if (op.isErase()) {
-            ++runResult.erases;
+        batch.keys[batch.size] = op.key;
+        batch.tags[batch.size] = op.tag;
+        if (++batch.size == OpBatch::CAPACITY) {
+            f(static_cast<const OpBatch &>(batch));
+            batch.size = 0;
         }
     }
+    if (batch.size != 0)
+        f(static_cast<const OpBatch &>(batch));
+    return true;
+}
 
-    std::cout << "  Operations breakdown: " << runResult.inserts
-              << " inserts, " << runResult.erases << " erases\n";
+// A streamed chunk's keys only live as long as the chunk, so a batch never
+// spans two chunks.
+template<typename F>
+bool for_each_op_batch(const StreamingTrace &trace, F &&f) {
+    return trace.for_each_chunk([&f](const std::vector<OperationRef> &chunk) {
+        for_each_op_batch(chunk, f);
+    });
+}
 
-    // ========================================================================
-    // One untimed warm-up run
-    // ========================================================================
-    table.clear();
-    std::cout << "  Starting warm-up run for N = " << runResult.run_meta_data.N << std::endl;
+// Replays every operation. Only HashTableDictionary has a batch hash; other
+// tables replay op by op either way.
+template<typename Table, typename Ops>
+void replay_ops(Table &table, const Ops &ops, bool /*batch_hash*/) {
+    for_each_op(ops, [&table](const auto &op) { apply_op(table, op); });
+}
 
-    for (const auto &op: ops) {
-        if (op.isInsert()) {
-            table.insert(op.key);
-        } else if (op.isErase()) {
-            table.remove(op.key);
+template<typename Ops>
+void replay_ops(HashTableDictionary &table, const Ops &ops, bool batch_hash) {
+    if (!batch_hash) {
+        for_each_op(ops, [&table](const auto &op) { apply_op(table, op); });
+        return;
+    }
+    for_each_op_batch(ops, [&table](const OpBatch &batch) {
+        HashTableDictionary::HashedKey hashed[OpBatch::CAPACITY];
+        table.hashBatch(batch.keys, batch.size, hashed);
+        for (std::size_t i = 0; i < batch.size; ++i) {
+            if (batch.tags[i] == OpCode::Insert) {
+                table.insert(batch.keys[i], hashed[i]);
+            } else if (batch.tags[i] == OpCode::Erase) {
+                table.remove(batch.keys[i], hashed[i]);
+            } else if (batch.tags[i] == OpCode::Lookup) {
+                table.member(batch.keys[i], hashed[i]);
+            }
         }
+    });
+}
+
+// ============================================================================
+// Replay session - one table replaying one trace, a trial at a time
+// ============================================================================
+// prepare() counts the operations (validating a streamed trace) and does the
+// untimed warm-up; run_trial() is one timed replay from an empty table
+// (false if a forked trial failed); finish() reports. Sessions of different table types can then be driven
+// in any order, e.g. interleaved A/B.
+class ReplaySession {
+public:
+    ReplaySession(RunResult &runResult, const TrialPolicy &policy) : runResult_(runResult), policy_(policy) {}
+    virtual ~ReplaySession() = default;
+
+    virtual bool prepare() = 0;
+    virtual bool run_trial() = 0;
+    virtual void finish() = 0;
+
+    bool wants_more_trials() const {
+        return policy_.wants_more(trials_ns_, static_cast<double>(spent_ns_) / 1e9);
     }
 
-    // ========================================================================
-    // Seven timed runs - report median
-    // ========================================================================
-    using clock = std::chrono::steady_clock;
-    const int numTrials = 7;
-    std::vector<std::int64_t> trials_ns;
-    trials_ns.reserve(numTrials);
+protected:
+    void add_trial(std::int64_t ns) {
+        trials_ns_.push_back(ns);
+        spent_ns_ += ns;
+    }
 
-    for (int i = 0; i < numTrials; ++i) {
-        table.clear();
-        std::cout << "  Timed run " << (i + 1) << "/" << numTrials
-                  << " for N = " << runResult.run_meta_data.N << std::endl;
+    // Median and its bootstrap confidence interval over all trials.
+    void summarize() {
+        const TrialSummary summary = summarize_trials(trials_ns_);
+        runResult_.elapsed_ns = static_cast<std::int64_t>(summary.median_ns);
+        runResult_.trials = summary.trials;
+        runResult_.ci_low_ns = static_cast<std::int64_t>(summary.ci_low_ns);
+        runResult_.ci_high_ns = static_cast<std::int64_t>(summary.ci_high_ns);
+        runResult_.outliers = summary.outliers;
+
+        std::cout << "  Median elapsed time: " << runResult_.elapsed_ms() << " ms over "
+                  << summary.trials << " trials, 95% CI [" << summary.ci_low_ns / 1e6 << ", "
+                  << summary.ci_high_ns / 1e6 << "] ms (+/-" << summary.relative_half_width() * 100 << "%)";
+        if (summary.outliers != 0)
+            std::cout << ", " << summary.outliers << " outlier(s)";
+        std::cout << "\n";
+    }
 
-        auto t0 = clock::now();
+    RunResult &runResult_;
+    const TrialPolicy &policy_;
+    std::vector<std::int64_t> trials_ns_;
+    std::int64_t spent_ns_ = 0;
+};
 
-        for (const auto &op: ops) {
+// Ops is any sequence of Operation or OperationRef (e.g. an OperationStream),
+// or a StreamingTrace. config and table_size describe table, so a forked
+// trial can build its own.
+template<typename HashTable, typename Ops>
+class TableReplay : public ReplaySession {
+public:
+    TableReplay(HashTable &table, const TableConfig &config, std::size_t table_size, RunResult &runResult,
+                const Ops &ops, const TrialPolicy &policy)
+        : ReplaySession(runResult, policy), table_(table), config_(config), table_size_(table_size), ops_(ops) {}
+
+    bool prepare() override {
+        // Count operations for sanity check; this also validates a streamed
+        // trace before anything is timed.
+        const bool readable = for_each_op(ops_, [this](const auto &op) {
             if (op.isInsert()) {
-                table.insert(op.key);
+                ++runResult_.inserts;
             } else if (op.isErase()) {
-                table.remove(op.key);
+                ++runResult_.erases;
+            } else if (op.isLookup()) {
+                ++runResult_.lookups;
             }
+        });
+        if (!readable)
+            return false;
+
+        std::cout << "  Operations breakdown: " << runResult_.inserts
+                  << " inserts, " << runResult_.erases << " erases, " << runResult_.lookups << " lookups\n";
+
+        // ====================================================================
+        // One untimed warm-up run (each forked trial does its own)
+        // ====================================================================
+        if (!runResult_.fork_trials) {
+            std::cout << "  Starting warm-up run for N = " << runResult_.run_meta_data.N << std::endl;
+            warm_up(table_);
         }
 
-        auto t1 = clock::now();
-        trials_ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+        // Counters, when requested, bracket exactly the timed replays.
+        if (runResult_.collect_perf) {
+            perf_.emplace();
+            if (!perf_->any_available()) {
+                std::cout << "  Hardware counters unavailable (perf_event_open failed); columns left empty\n";
+                perf_.reset();
+            }
+        }
+        return true;
     }
 
-    // Find median
-    const size_t mid = trials_ns.size() / 2;
-    std::nth_element(trials_ns.begin(), trials_ns.begin() + mid, trials_ns.end());
-    runResult.elapsed_ns = trials_ns[mid];
+    bool run_trial() override {
+        std::cout << "  Timed run " << (trials_ns_.size() + 1)
+                  << " for N = " << runResult_.run_meta_data.N << std::endl;
+        TraceSpan span("trial", "harness", "trial", static_cast<std::int64_t>(trials_ns_.size() + 1),
+                       "N", runResult_.run_meta_data.N);
+
+        if (runResult_.fork_trials) {
+            // The child builds its own table on the heap it inherited, warms
+            // it up and sends back its time and statistics; nothing a trial
+            // allocates or frees reaches the parent or the next trial.
+            const auto reply = run_forked([this] {
+                std::string result;
+                with_table(config_, table_size_, runResult_.hash_seed, [&](auto &table) {
+                    warm_up(table);
+                    const std::int64_t ns = timed_replay(table);
+                    result = std::to_string(ns) + "\n" + table.csvStats();
+                });
+                return result;
+            });
+            const auto newline = reply ? reply->find('\n') : std::string::npos;
+            if (newline == std::string::npos)
+                return false;
+            add_trial(std::stoll(reply->substr(0, newline)));
+            runResult_.hash_table_stats_csv = reply->substr(newline + 1);
+            return true;
+        }
 
-    // ========================================================================
-    // Capture hash table statistics
-    // ========================================================================
-    // After the final timed run, the table is still populated
-    // Get its statistics via csvStats()
-    runResult.hash_table_stats_csv = table.csvStats();
+        add_trial(timed_replay(table_));
 
-    std::cout << "  Median elapsed time: " << runResult.elapsed_ms() << " ms\n";
+        // ====================================================================
+        // Capture hash table statistics
+        // ====================================================================
+        // After each timed run the table is still populated; the last one's
+        // statistics are reported, as every run replays the same trace.
+        runResult_.hash_table_stats_csv = table_.csvStats();
+        return true;
+    }
 
-    return runResult;
-}
+    void finish() override {
+        summarize();
 
-// ============================================================================
-// Load trace file - adapted for LRU format (I key, E key)
-// ============================================================================
-bool load_trace_strict_header(const std::string &path,
-                              RunMetaData &runMeta,
-                              std::vector<Operation> &out_operations) {
-    out_operations.clear();
-
-    std::ifstream in(path);
-    if (!in.is_open()) {
-        std::cerr << "ERROR: Cannot open trace file: " << path << "\n";
-        return false;
+        if (perf_) {
+            runResult_.perf = perf_->per_op(static_cast<std::uint64_t>(runResult_.total_ops()) * trials_ns_.size());
+            std::cout << "  Per op:";
+            for (std::size_t i = 0; i < PerfSummary::NUM_EVENTS; ++i) {
+                if (runResult_.perf.per_op[i] >= 0.0)
+                    std::cout << " " << PerfSummary::column(i) << "=" << runResult_.perf.per_op[i];
+            }
+            std::cout << "\n";
+        }
+
+        // ====================================================================
+        // Optional latency pass - every k-th op timed on its own
+        // ====================================================================
+        // Kept out of the timed trials so the clock reads do not inflate the
+        // median; compaction pauses show up here as the insert tail.
+        if (runResult_.latency_sample_every != 0) {
+            TraceSpan span("latency_pass");
+            LatencyHistogram insert_latency;
+            LatencyHistogram erase_latency;
+            LatencyHistogram lookup_latency;
+            const unsigned every = runResult_.latency_sample_every;
+            unsigned countdown = 1;
+
+            table_.clear();
+            for_each_op(ops_, [&](const auto &op) {
+                if (--countdown != 0) {
+                    replay(op);
+                    return;
+                }
+                countdown = every;
+                const auto t0 = clock::now();
+                replay(op);
+                const auto t1 = clock::now();
+                const auto ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+                (op.isInsert() ? insert_latency : op.isErase() ? erase_latency : lookup_latency).record(ns);
+            });
+
+            runResult_.insert_latency = insert_latency.summary();
+            runResult_.erase_latency = erase_latency.summary();
+            runResult_.lookup_latency = lookup_latency.summary();
+            std::cout << "  Insert latency p50/p99/p99.9/max: " << runResult_.insert_latency.p50_ns << "/"
+                      << runResult_.insert_latency.p99_ns << "/" << runResult_.insert_latency.p999_ns << "/"
+                      << runResult_.insert_latency.max_ns << " ns\n";
+            std::cout << "  Erase latency p50/p99/p99.9/max: " << runResult_.erase_latency.p50_ns << "/"
+                      << runResult_.erase_latency.p99_ns << "/" << runResult_.erase_latency.p999_ns << "/"
+                      << runResult_.erase_latency.max_ns << " ns\n";
+            if (runResult_.lookup_latency.count != 0) {
+                std::cout << "  Lookup latency p50/p99/p99.9/max: " << runResult_.lookup_latency.p50_ns << "/"
+                          << runResult_.lookup_latency.p99_ns << "/" << runResult_.lookup_latency.p999_ns << "/"
+                          << runResult_.lookup_latency.max_ns << " ns\n";
+            }
+        }
+
+        // ====================================================================
+        // Optional windowed pass - counters sampled every K ops
+        // ====================================================================
+        if (runResult_.window_ops != 0) {
+            TraceSpan span("window_pass");
+            WindowRecorder recorder(runResult_.window_ops);
+            table_.clear();
+            recorder.start(table_.counters());
+            for_each_op(ops_, [&](const auto &op) {
+                replay(op);
+                recorder.op(op.tag, table_);
+            });
+            recorder.finish(table_);
+            runResult_.windows = recorder.rows();
+            std::cout << "  Recorded " << runResult_.windows.size() << " windows of " << runResult_.window_ops
+                      << " ops\n";
+        }
+
+        // ====================================================================
+        // Optional open-loop passes - one per target rate
+        // ====================================================================
+        for (double rate: runResult_.open_loop_rates) {
+            TraceSpan span("open_loop_pass", "harness", "target_ops_per_sec", static_cast<std::int64_t>(rate));
+            ArrivalSchedule schedule(rate, runResult_.arrivals);
+            LatencyHistogram response;
+            table_.clear();
+
+            const auto start = clock::now();
+            auto intended = start;
+            for_each_op(ops_, [&](const auto &op) {
+                intended += std::chrono::nanoseconds(schedule.next_gap_ns());
+                while (clock::now() < intended) {
+                    // running early: wait for the op's arrival
+                }
+                replay(op);
+                const auto done = clock::now();
+                response.record(static_cast<std::uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(done - intended).count()));
+            });
+            const double secs = std::chrono::duration<double>(clock::now() - start).count();
+
+            OpenLoopPoint point;
+            point.target_ops_per_sec = rate;
+            point.achieved_ops_per_sec = secs > 0.0 ? static_cast<double>(response.count()) / secs : 0.0;
+            point.response = response.summary();
+            runResult_.open_loop.push_back(point);
+            std::cout << "  Open loop at " << rate << " ops/s (" << arrival_process_name(runResult_.arrivals)
+                      << "): achieved " << point.achieved_ops_per_sec << " ops/s, response p50/p99/p99.9/max "
+                      << point.response.p50_ns << "/" << point.response.p99_ns << "/" << point.response.p999_ns
+                      << "/" << point.response.max_ns << " ns" << (point.sustainable() ? "" : "  (not sustained)")
+                      << "\n";
+        }
     }
 
-    // ========================================================================
-    // Read FIRST line as header: <profile> <N> <seed>
-    // Example: lru_profile 1024 23
-    // ========================================================================
-    std::string header;
-    if (!std::getline(in, header)) {
-        std::cerr << "ERROR: Empty trace file\n";
-        return false;
+private:
+    using clock = std::chrono::steady_clock;
+
+    template<typename Table>
+    void warm_up(Table &table) {
+        TraceSpan span("warm_up", "harness", "N", runResult_.run_meta_data.N);
+        table.clear();
+        replay_ops(table, ops_, runResult_.batch_hash);
     }
 
-    const auto first = header.find_first_not_of(" \t\r\n");
-    if (first == std::string::npos || header[first] == '#') {
-        std::cerr << "ERROR: Invalid header line\n";
-        return false;
+    // One timed replay from an empty table, after evicting the caches in
+    // cold mode; returns nanoseconds.
+    template<typename Table>
+    std::int64_t timed_replay(Table &table) {
+        table.clear();
+        if (runResult_.cold_cache)
+            thread_cache_evictor().evict();
+
+        if (perf_)
+            perf_->start();
+        auto t0 = clock::now();
+
+        replay_ops(table, ops_, runResult_.batch_hash);
+
+        auto t1 = clock::now();
+        if (perf_)
+            perf_->stop();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+    }
+
+    template<typename Op>
+    void replay(const Op &op) {
+        apply_op(table_, op);
     }
 
-    std::istringstream hdr(header);
-    std::string profile;
-    int N = 0;
-    int seed = 0;
+    HashTable &table_;
+    const TableConfig &config_;
+    std::size_t table_size_;
+    const Ops &ops_;
+    std::optional<PerfCounters> perf_;
+};
 
-    if (!(hdr >> profile >> N >> seed)) {
-        std::cerr << "ERROR: Cannot parse header: " << header << "\n";
+// ============================================================================
+// Timing function - runs hash table operations and measures time
+// ============================================================================
+// Warm-up, then timed trials until the policy is satisfied (seven by
+// default), reporting the median. Returns false if the operations could not
+// be read.
+template<typename HashTable, typename Ops>
+bool run_trace_ops(HashTable &table,
+                   const TableConfig &config,
+                   std::size_t table_size,
+                   RunResult &runResult,
+                   const Ops &ops,
+                   const TrialPolicy &policy = TrialPolicy()) {
+    TableReplay<HashTable, Ops> session(table, config, table_size, runResult, ops, policy);
+    if (!session.prepare())
         return false;
+    while (session.wants_more_trials()) {
+        if (!session.run_trial())
+            return false;
     }
+    session.finish();
+    return true;
+}
 
-    runMeta.profile = profile;
-    runMeta.N = N;
-    runMeta.seed = seed;
+// Interleaved A/B: each round runs one trial of every session that still
+// wants one, so slow drift (thermal, frequency, other tenants) lands on all
+// configurations alike instead of on whichever ran last.
+inline bool run_interleaved(const std::vector<ReplaySession *> &sessions) {
+    for (auto *session: sessions) {
+        if (!session->prepare())
+            return false;
+    }
+    for (bool any = true; any;) {
+        any = false;
+        for (auto *session: sessions) {
+            if (session->wants_more_trials()) {
+                if (!session->run_trial())
+                    return false;
+                any = true;
+            }
+        }
+    }
+    for (auto *session: sessions)
+        session->finish();
+    return true;
+}
 
-    std::cout << "Loaded trace: " << profile << " N=" << N << " seed=" << seed << "\n";
+// ============================================================================
+// A trace shared read-only by all of its jobs
+// ============================================================================
+// The first job to need the trace loads it (or opens it for streaming); the
+// last job to finish releases it, so with one worker only one trace is
+// resident at a time, as before.
+struct SharedTrace {
+    std::string path;
+    std::string baseName;
+    std::once_flag loadOnce;
+    std::once_flag prefetchOnce;
+    bool loaded = false;
+    RunMetaData runMeta;
+    OperationStream operations;
+    StreamingTrace stream;
+    std::atomic<std::size_t> jobsLeft{0};
+
+    // parse_threads as for load_trace_mmap; 0 uses every allowed CPU.
+    bool acquire(bool streaming, unsigned parse_threads = 0) {
+        std::call_once(loadOnce, [this, streaming, parse_threads] {
+            std::cout << "\n========================================\n";
+            std::cout << "Processing: " << baseName << "\n";
+            std::cout << "========================================\n";
+            TraceSpan span(streaming ? "open_trace" : "load_trace");
+            loaded = streaming ? stream.open(path, runMeta) : load_any_trace(path, runMeta, operations, parse_threads);
+            span.setArg("N", runMeta.N);
+            if (!loaded)
+                std::cerr << "ERROR: Failed to load trace: " << path << "\n";
+        });
+        return loaded;
+    }
 
-    // ========================================================================
-    // Read operation lines: I key  or  E key
-    // ========================================================================
-    std::string line;
-    int line_num = 1;  // header is line 1
+    void release() {
+        if (--jobsLeft == 0)
+            operations = OperationStream();
+    }
+};
 
-    while (std::getline(in, line)) {
-        ++line_num;
+// ============================================================================
+// One job: replay one trace against one table configuration
+// ============================================================================
+int table_size_for_config(const TableConfig &config, const RunMetaData &runMeta) {
+    const auto N = static_cast<std::size_t>(runMeta.N);
+    return static_cast<int>(config.targetLoadFactor > 0.0 ? tableSizeForLoad(N, config.targetLoadFactor)
+                                                          : tableSizeForN(N));
+}
 
-        // Skip blank lines and comments
-        const auto opCodeIdx = line.find_first_not_of(" \t\r\n");
-        if (opCodeIdx == std::string::npos || line[opCodeIdx] == '#') {
-            continue;
-        }
+RunResult make_run_result(const TableConfig &config, const SharedTrace &trace, const SweepConfig &options) {
+    RunResult result(trace.runMeta);
+    result.impl = config.impl;
+    result.trace_path = trace.baseName;
+    result.latency_sample_every = options.latency_sample_every;
+    result.window_ops = options.window_ops;
+    result.open_loop_rates = options.open_loop_rates;
+    result.arrivals = options.arrivals;
+    result.collect_perf = options.collect_perf;
+    result.cold_cache = options.cold_cache;
+    result.fork_trials = options.fork_trials;
+    const bool tunable = find_table_implementation(config.implementation)->tunable;
+    result.batch_hash = tunable && options.batch_hash;
+    result.hash_policy = tunable ? hash_policy_name(config.hashPolicy) : "n/a";
+    if (tunable && config.hashPolicy != HashTableDictionary::POLYNOMIAL)
+        result.hash_seed = options.hash_seed >= 0 ? options.hash_seed : trace.runMeta.seed;
+    result.compaction_trigger = config.compaction ? config.compactionRate : 0.0;
+    result.target_load_factor = config.targetLoadFactor;
+    return result;
+}
 
-        std::istringstream iss(line.substr(opCodeIdx));
-        std::string opcode_str;
-        if (!(iss >> opcode_str)) {
-            continue;  // empty line
-        }
+// ============================================================================
+// Memory pass - a fresh table built and replayed under a HeapScope
+// ============================================================================
+// Counted from before construction, so the retained bytes are the whole heap
+// footprint of the final table: slot arrays plus out-of-line key storage.
+template<typename Ops>
+void measure_memory(const TableConfig &config, const Ops &operations, const SharedTrace &trace, RunResult &result) {
+    const int table_size = table_size_for_config(config, trace.runMeta);
+    TraceSpan span("memory_pass");
+    HeapScope scope;
+    with_table(config, static_cast<std::size_t>(table_size), result.hash_seed, [&](auto &table) {
+        for_each_op(operations, [&table](const auto &op) { apply_op(table, op); });
+        result.memory = scope.sample(table.counters().active);
+    });
+
+    const MemorySummary &m = result.memory;
+    std::cout << "  Memory: peak RSS " << m.peak_rss_kb << " kB, peak heap " << m.peak_heap_bytes << " B, "
+              << m.allocations << " allocations, " << m.bytes_per_key << " B per resident key\n";
+}
 
-        // Parse opcodes
-        // IMPORTANT: Keys consist of TWO words separated by space
-        // Format: I word1 word2  or  E word1 word2
-        if (opcode_str == "I") {
-            std::string w1, w2;
-            if (!(iss >> w1 >> w2)) {
-                std::cerr << "ERROR: Line " << line_num << ": Insert missing key (needs two words)\n";
-                return false;
-            }
-            // Combine into single key with space: "word1 word2"
-            std::string key = w1 + " " + w2;
-            out_operations.emplace_back(OpCode::Insert, key);
-
-        } else if (opcode_str == "E") {
-            std::string w1, w2;
-            if (!(iss >> w1 >> w2)) {
-                std::cerr << "ERROR: Line " << line_num << ": Erase missing key (needs two words)\n";
-                return false;
-            }
-            // Combine into single key with space: "word1 word2"
-            std::string key = w1 + " " + w2;
-            out_operations.emplace_back(OpCode::Erase, key);
+template<typename Ops>
+void run_table_config(const TableConfig &config,
+                      const Ops &operations,
+                      const SharedTrace &trace,
+                      const SweepConfig &options,
+                      std::optional<RunResult> &out) {
+    const int table_size = table_size_for_config(config, trace.runMeta);
+    std::cout << "\n--- " << config.label << ": " << trace.baseName
+              << " (M = " << table_size << ") ---\n";
+
+    RunResult result = make_run_result(config, trace, options);
+    bool ok = false;
+    with_table(config, static_cast<std::size_t>(table_size), result.hash_seed, [&](auto &table) {
+        ok = run_trace_ops(table, config, static_cast<std::size_t>(table_size), result, operations,
+                           options.trial_policy);
+    });
+    if (ok && options.memory)
+        measure_memory(config, operations, trace, result);
+    if (ok)
+        out = std::move(result);
+}
 
-        } else {
-            std::cerr << "ERROR: Line " << line_num << ": Unknown opcode '"
-                      << opcode_str << "'\n";
-            return false;
-        }
+// ============================================================================
+// One interleaved job: every configuration over one trace, trial by trial
+// ============================================================================
+// Tables of different types are built by nesting with_table() calls, one
+// level per configuration, so all of them are alive for the interleaved run.
+template<typename Ops>
+void build_sessions(const std::vector<TableConfig> &configs,
+                    std::size_t next,
+                    const Ops &operations,
+                    const SharedTrace &trace,
+                    const SweepConfig &options,
+                    std::vector<RunResult> &results,
+                    std::vector<std::unique_ptr<ReplaySession>> &sessions,
+                    bool &ok) {
+    if (next == configs.size()) {
+        std::vector<ReplaySession *> order;
+        for (auto &session: sessions)
+            order.push_back(session.get());
+        ok = run_interleaved(order);
+        return;
     }
 
-    std::cout << "  Loaded " << out_operations.size() << " operations\n";
-    return true;
+    const int table_size = table_size_for_config(configs[next], trace.runMeta);
+    std::cout << "  [" << next << "] " << configs[next].label << " (M = " << table_size << ")\n";
+    with_table(configs[next], static_cast<std::size_t>(table_size), results[next].hash_seed, [&](auto &table) {
+        using Table = std::decay_t<decltype(table)>;
+        sessions.push_back(std::make_unique<TableReplay<Table, Ops>>(table, configs[next],
+                                                                     static_cast<std::size_t>(table_size),
+                                                                     results[next], operations,
+                                                                     options.trial_policy));
+        build_sessions(configs, next + 1, operations, trace, options, results, sessions, ok);
+    });
+}
+
+template<typename Ops>
+void run_interleaved_configs(const std::vector<TableConfig> &configs,
+                             const Ops &operations,
+                             const SharedTrace &trace,
+                             const SweepConfig &options,
+                             std::optional<RunResult> *out) {
+    std::cout << "\n--- Interleaved trials: " << trace.baseName << " ---\n";
+    std::vector<RunResult> results;
+    for (const auto &config: configs)
+        results.push_back(make_run_result(config, trace, options));
+
+    std::vector<std::unique_ptr<ReplaySession>> sessions;
+    bool ok = false;
+    build_sessions(configs, 0, operations, trace, options, results, sessions, ok);
+    if (!ok)
+        return;
+    // Each memory pass runs alone, after every session's tables are gone.
+    if (options.memory) {
+        for (std::size_t i = 0; i < results.size(); ++i)
+            measure_memory(configs[i], operations, trace, results[i]);
+    }
+    for (std::size_t i = 0; i < results.size(); ++i)
+        out[i] = std::move(results[i]);
 }
 
 // ============================================================================
@@ -255,7 +666,7 @@ void find_trace_files_or_die(const std::string &dir,
         std::exit(1);
     }
 
-    const std::string suffix = ".trace";
+    const std::vector<std::string> suffixes = {".trace", ".btrace"};
     for (const auto &entry: it) {
         if (!entry.is_regular_file(ec)) {
             if (ec) {
@@ -268,9 +679,12 @@ void find_trace_files_or_die(const std::string &dir,
 
         const std::string name = entry.path().filename().string();
         const bool has_prefix = (name.rfind(profile_prefix, 0) == 0);
-        const bool has_suffix = name.size() >= suffix.size() &&
-                                name.compare(name.size() - suffix.size(),
-                                             suffix.size(), suffix) == 0;
+        bool has_suffix = false;
+        for (const auto &suffix: suffixes) {
+            has_suffix = has_suffix || (name.size() >= suffix.size() &&
+                                        name.compare(name.size() - suffix.size(),
+                                                     suffix.size(), suffix) == 0);
+        }
 
         if (has_prefix && has_suffix) {
             out_files.push_back(entry.path().string());
@@ -280,12 +694,88 @@ void find_trace_files_or_die(const std::string &dir,
     std::sort(out_files.begin(), out_files.end());
 }
 
+// True when rows under `header` can be appended to `path`: it is missing,
+// empty, or already starts with that header. Otherwise rows of the current
+// columns would land under another version's names.
+bool csv_header_matches(const std::filesystem::path &path, const std::string &header) {
+    namespace fs = std::filesystem;
+    if (!fs::exists(path) || fs::file_size(path) == 0)
+        return true;
+    std::ifstream existing(path);
+    std::string firstLine;
+    std::getline(existing, firstLine);
+    if (firstLine == header)
+        return true;
+    std::cerr << "ERROR: " << path << " has different columns than this harness writes;"
+              << " move it aside or choose another file with --out\n";
+    return false;
+}
+
+// Opens `path` for appending rows under `header`, writing the header if the
+// file is new.
+bool open_csv_for_append(const std::filesystem::path &path, const std::string &header, std::ofstream &csv) {
+    namespace fs = std::filesystem;
+    if (!csv_header_matches(path, header))
+        return false;
+    const bool needHeader = !fs::exists(path) || fs::file_size(path) == 0;
+
+    csv.open(path, std::ios::app);
+    if (!csv) {
+        std::cerr << "ERROR: cannot open " << path << " for writing\n";
+        return false;
+    }
+    if (needHeader)
+        csv << header << '\n';
+    return true;
+}
+
+// Appends one side CSV's rows for every run.
+bool append_side_csv(const std::filesystem::path &path,
+                     const std::string &header,
+                     const std::vector<RunResult> &runs,
+                     std::string (RunResult::*rows)() const) {
+    std::ofstream csv;
+    if (!open_csv_for_append(path, header, csv))
+        return false;
+    for (const auto &run: runs)
+        csv << (run.*rows)();
+    csv.flush();
+    return true;
+}
+
 // ============================================================================
 // Main
 // ============================================================================
-int main() {
-    const auto profileName = std::string("lru_profile");
-    const auto traceDir = std::string("../traceFiles");  // Adjust path as needed
+int main(int argc, char *argv[]) {
+    // Everything the sweep varies comes from flags or a --config file; with
+    // no arguments this is the original single/double run at 0.95.
+    SweepConfig options;
+    if (!options.parse_args(argc, argv)) {
+        SweepConfig::print_usage(argv[0]);
+        return 1;
+    }
+    if (options.memory)
+        enable_heap_accounting();
+    if (!options.trace_events_path.empty()) {
+        enableTraceEvents();
+        nameTraceThread("main");
+    }
+
+    // Output files, checked before the sweep rather than after it
+    namespace fs = std::filesystem;
+    const fs::path csvDir = "../csvs";
+    const fs::path csvPath = csvDir / options.csv_name;
+    const fs::path windowsPath = csvDir / (csvPath.stem().string() + "_windows" + csvPath.extension().string());
+    const fs::path openLoopPath = csvDir / (csvPath.stem().string() + "_openloop" + csvPath.extension().string());
+    if (!csv_header_matches(csvPath, RunResult::csv_header()) ||
+        (options.window_ops != 0 && !csv_header_matches(windowsPath, RunResult::windows_csv_header())) ||
+        (!options.open_loop_rates.empty() && !csv_header_matches(openLoopPath, RunResult::open_loop_csv_header()))) {
+        return 1;
+    }
+
+    const auto profileName = options.profile;
+    const auto traceDir = options.trace_dir;
+    const std::vector<TableConfig> tableConfigs = options.table_configs();
 
     std::vector<std::string> traceFiles;
     find_trace_files_or_die(traceDir, profileName, traceFiles);
@@ -297,95 +787,85 @@ int main() {
 
     std::cout << "Found " << traceFiles.size() << " trace files\n";
 
-    std::vector<RunResult> runResults;
-
     // ========================================================================
-    // Process each trace file
+    // Queue one job per (trace, configuration), trace-major; with
+    // --interleave, one job per trace running all of its configurations
     // ========================================================================
-
-    /*for (const auto& traceFile : traceFiles) {
-        // ====================================================================
-        // QUICK TEST MODE: Only process N=1024 for fast iteration
-        // Comment out these 3 lines to process all traces
-        // ====================================================================
-        if (traceFile.find("N_1024") == std::string::npos) {
-            continue;  // Skip files that aren't N=1024
+    std::deque<SharedTrace> traces;
+    std::vector<std::optional<RunResult>> jobResults(traceFiles.size() * tableConfigs.size());
+    BenchmarkScheduler scheduler(options.concurrency);
+
+    // A streamed trace has nothing to load ahead, a forked trial must not
+    // inherit a running loader thread, and a second resident trace would
+    // show up in --memory's peak RSS.
+    const std::size_t jobCount = options.interleave ? traceFiles.size() : traceFiles.size() * tableConfigs.size();
+    const unsigned workers = static_cast<unsigned>(std::min<std::size_t>(scheduler.concurrency(), jobCount));
+    TracePrefetcher prefetcher(options.prefetch && traceFiles.size() > 1 && !options.streaming &&
+                               !options.fork_trials && !options.memory, workers);
+    if (prefetcher.enabled())
+        std::cout << "Prefetching the next trace on core " << prefetcher.core() << "\n";
+
+    // The first job of trace t loads it, then queues trace t + 1.
+    auto acquire_trace = [&traces, &prefetcher, &options](std::size_t t) {
+        SharedTrace &trace = traces[t];
+        const bool loaded = trace.acquire(options.streaming);
+        if (t + 1 < traces.size()) {
+            std::call_once(trace.prefetchOnce, [&traces, &prefetcher, t] {
+                SharedTrace &next = traces[t + 1];
+                // The loader owns a single core; parse threads would all
+                // inherit it, so it parses alone.
+                prefetcher.prefetch([&next] { next.acquire(false, 1); });
+            });
         }
+        return loaded;
+    };
 
+    for (const auto &traceFile: traceFiles) {
+        const std::size_t t = traces.size();
+        SharedTrace &trace = traces.emplace_back();
         const auto pos = traceFile.find_last_of("/\\");
-        auto traceFileBaseName = (pos == std::string::npos) ? traceFile : traceFile.substr(pos + 1);
-
-        std::cout << "\n========================================\n";
-        std::cout << "Processing: " << traceFileBaseName << "\n";
-        std::cout << "========================================\n";
-
-        // Load trace
-        std::vector<Operation> operations;
-        RunMetaData run_meta_data;
-        if (!load_trace_strict_header(traceFile, run_meta_data, operations)) {
-            std::cerr << "ERROR: Failed to load trace: " << traceFile << "\n";
-            continue;
-        }*/
-
-    for (const auto& traceFile : traceFiles) {
-        const auto pos = traceFile.find_last_of("/\\");
-        auto traceFileBaseName = (pos == std::string::npos) ? traceFile : traceFile.substr(pos + 1);
-
-        std::cout << "\n========================================\n";
-        std::cout << "Processing: " << traceFileBaseName << "\n";
-        std::cout << "========================================\n";
-
-        // Load trace
-        std::vector<Operation> operations;
-        RunMetaData run_meta_data;
-        if (!load_trace_strict_header(traceFile, run_meta_data, operations)) {
-            std::cerr << "ERROR: Failed to load trace: " << traceFile << "\n";
+        trace.path = traceFile;
+        trace.baseName = (pos == std::string::npos) ? traceFile : traceFile.substr(pos + 1);
+        trace.jobsLeft = options.interleave ? 1 : tableConfigs.size();
+
+        if (options.interleave) {
+            // One job per trace; its results fill that trace's slots in order.
+            std::optional<RunResult> *out = &jobResults[scheduler.size() * tableConfigs.size()];
+            scheduler.add([&trace, &tableConfigs, out, &options, &acquire_trace, t] {
+                if (acquire_trace(t)) {
+                    if (options.streaming)
+                        run_interleaved_configs(tableConfigs, trace.stream, trace, options, out);
+                    else
+                        run_interleaved_configs(tableConfigs, trace.operations, trace, options, out);
+                }
+                trace.release();
+            });
             continue;
         }
 
-        // Get table size for this N
-        int table_size = get_table_size_for_N(run_meta_data.N);
-        std::cout << "  Table size M for N=" << run_meta_data.N << ": " << table_size << "\n";
-
-        // ====================================================================
-        // Run 1: Single probing with compaction
-        // ====================================================================
-        std::cout << "\n--- Single Probing (compaction ON) ---\n";
-        {
-            RunResult result_single(run_meta_data);
-            result_single.impl = "hash_map_single";
-            result_single.trace_path = traceFileBaseName;
-
-            HashTableDictionary table_single(
-                table_size,
-                HashTableDictionary::SINGLE,  // Single probing
-                true,                          // Compaction ON
-                0.95                           // Default compaction trigger
-            );
-
-            run_trace_ops(table_single, result_single, operations);
-            runResults.push_back(result_single);
+        for (const auto &config: tableConfigs) {
+            std::optional<RunResult> &out = jobResults[scheduler.size()];
+            scheduler.add([&trace, &config, &out, &options, &acquire_trace, t] {
+                if (acquire_trace(t)) {
+                    if (options.streaming)
+                        run_table_config(config, trace.stream, trace, options, out);
+                    else
+                        run_table_config(config, trace.operations, trace, options, out);
+                }
+                trace.release();
+            });
         }
+    }
 
-        // ====================================================================
-        // Run 2: Double probing with compaction
-        // ====================================================================
-        std::cout << "\n--- Double Probing (compaction ON) ---\n";
-        {
-            RunResult result_double(run_meta_data);
-            result_double.impl = "hash_map_double";
-            result_double.trace_path = traceFileBaseName;
-
-            HashTableDictionary table_double(
-                table_size,
-                HashTableDictionary::DOUBLE,  // Double probing
-                true,                          // Compaction ON
-                0.95                           // Default compaction trigger
-            );
-
-            run_trace_ops(table_double, result_double, operations);
-            runResults.push_back(result_double);
-        }
+    scheduler.run();
+    if (!options.trace_events_path.empty())
+        writeTraceEvents(options.trace_events_path);
+
+    // Results keep job order, whichever worker finished first.
+    std::vector<RunResult> runResults;
+    for (auto &result: jobResults) {
+        if (result)
+            runResults.push_back(std::move(*result));
     }
 
     // ========================================================================
@@ -406,27 +886,15 @@ int main() {
         std::cout << run.to_csv_row() << std::endl;
     }
 
-    // Write to CSV file
-    namespace fs = std::filesystem;
-    const fs::path csvDir = "../csvs";
-    const fs::path csvPath = csvDir / "lru_profile.csv";
-
-    // Create directory if needed
+    // Write to CSV file, creating the directory if needed
     if (!fs::exists(csvDir)) {
         fs::create_directories(csvDir);
     }
 
-    const bool needHeader = !fs::exists(csvPath) || fs::file_size(csvPath) == 0;
-
-    std::ofstream csv(csvPath, std::ios::app);
-    if (!csv) {
-        std::cerr << "ERROR: cannot open " << csvPath << " for writing\n";
+    std::ofstream csv;
+    if (!open_csv_for_append(csvPath, RunResult::csv_header(), csv)) {
         return 1;
     }
-
-    if (needHeader) {
-        csv << RunResult::csv_header() << '\n';
-    }
     for (const auto& run : runResults) {
         csv << run.to_csv_row() << '\n';
     }
@@ -434,5 +902,63 @@ int main() {
 
     std::cout << "\nResults written to: " << csvPath << "\n";
 
+    // Side CSVs beside it, e.g. lru_profile_windows.csv
+    if (options.window_ops != 0) {
+        if (!append_side_csv(windowsPath, RunResult::windows_csv_header(), runResults, &RunResult::windows_to_csv))
+            return 1;
+        std::cout << "Window series written to: " << windowsPath << "\n";
+    }
+    if (!options.open_loop_rates.empty()) {
+        if (!append_side_csv(openLoopPath, RunResult::open_loop_csv_header(), runResults, &RunResult::open_loop_to_csv))
+            return 1;
+        std::cout << "Open-loop sweep written to: " << openLoopPath << "\n";
+
+        // Each run's knee: the highest offered rate at and below which it
+        // sustained every rate. The sweep's is the lowest of those, so every
+        // run sustained it and everything under it.
+        std::cout << "Open-loop knees:\n";
+        double sweepKnee = std::numeric_limits<double>::infinity();
+        for (const auto& run : runResults) {
+            std::vector<OpenLoopPoint> points = run.open_loop;
+            std::sort(points.begin(), points.end(), [](const OpenLoopPoint &a, const OpenLoopPoint &b) {
+                return a.target_ops_per_sec < b.target_ops_per_sec;
+            });
+            double knee = 0.0;
+            for (const auto& point : points) {
+                if (!point.sustainable())
+                    break;
+                knee = point.target_ops_per_sec;
+            }
+            sweepKnee = std::min(sweepKnee, knee);
+            std::cout << "  " << BaselineRun::key_of(run) << ": ";
+            if (knee > 0.0)
+                std::cout << knee << " ops/s\n";
+            else
+                std::cout << "no rate sustained\n";
+        }
+        if (std::isfinite(sweepKnee) && sweepKnee > 0.0)
+            std::cout << "Highest rate sustained by every run: " << sweepKnee << " ops/s\n";
+        else
+            std::cout << "No rate was sustained by every run\n";
+    }
+
+    // ========================================================================
+    // Regression gate
+    // ========================================================================
+    const BuildEnvironment environment = BuildEnvironment::current();
+    if (!options.write_baseline_path.empty()) {
+        if (!write_baseline(options.write_baseline_path, environment, runResults))
+            return 1;
+        std::cout << "Baseline written to: " << options.write_baseline_path << "\n";
+    }
+    if (!options.baseline_path.empty()) {
+        BuildEnvironment baselineEnvironment;
+        std::vector<BaselineRun> baseline;
+        if (!load_baseline(options.baseline_path, baselineEnvironment, baseline))
+            return 1;
+        if (check_regressions(baselineEnvironment, baseline, environment, runResults, options.tolerance) != 0)
+            return 2;
+    }
+
     return 0;
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include <sstream>
 
 #include "Operations.hpp"
+#include "TableSizes.hpp"
 
 // The first line of the header must contain:  <profile> <N> <seed>
 // After the header: blank lines and lines starting with '#' are okay
@@ -66,6 +67,9 @@ bool load_trace_strict_header(const std::string &path,
             if (!(iss >> w1 >> w2)) return false;
 //            std::cout << "w1 = " << w1 << " w2 = " << w2 << std::endl;
             out_operations.emplace_back(OpCode::Erase, w1.append(" ") + w2);
+        } else if (tok == "L") {
+            if (!(iss >> w1 >> w2)) return false;
+            out_operations.emplace_back(OpCode::Lookup, w1.append(" ") + w2);
         } else {
             std::cout << "Unknown operation in load_trace_strict_header: " << tok << std::endl;
             return false; // unknown token
@@ -75,30 +79,6 @@ bool load_trace_strict_header(const std::string &path,
     return true;
 }
 
-std::size_t tableSizeForN(std::size_t N) {
-   static const std::vector<std::pair<std::size_t, std::size_t>> N_and_primes = {
-        /* N = 2^10 = 1,024  */ { 1024,    1279    },
-        /* N = 2^11 = 2,048  */ { 2048,    2551    },
-        /* N = 2^12 = 4,096  */ { 4096,    5101    },
-        /* N = 2^13 = 8,192  */ { 8192,   10273   },
-        /* N = 2^14 = 16,384 */ { 16384,   20479   },
-        /* N = 2^15 = 32,768 */ { 32768,   40849   },
-        /* N = 2^16 = 65,536 */ { 65536,   81931   },
-        /* N = 2^17 = 131,072*/ { 131072,  163861  },
-        /* N = 2^18 = 262,144*/ { 262144,  327739  },
-        /* N = 2^19 = 524,288*/ { 524288,  655243  },
-        /* N = 2^20 = 1,048,576*/{ 1048576, 1310809 }
-    };
-
-    for (auto item: N_and_primes) {
-        if (item.first == N)
-            return item.second;
-    }
-    std::cout << "Unable to find table size for " << N << " in RunMetaData." << std::endl;
-    exit(1);
-}
-
-
 int main(int argc, char *argv[]) {
 
 
@@ -121,9 +101,11 @@ int main(int argc, char *argv[]) {
 
     HashTableDictionary::PROBE_TYPE pType = HashTableDictionary::DOUBLE;
     auto doWePerformCompaction = true;
+    const std::size_t tableSize = tableSizeForN(N);
     HashTableDictionary hashDictionary(
-            tableSizeForN(N), pType, doWePerformCompaction);
+            tableSize, pType, doWePerformCompaction);
 
+    hashDictionary.recordStructureTimeline(operations.size() / 100 + 1);
     hashDictionary.clear();
     std::cout << "Starting a run with N = " << N << " and " << operations.size() << " operations." << std::endl;
     for (const auto &op: operations) {
@@ -136,6 +118,9 @@ int main(int argc, char *argv[]) {
             case OpCode::Erase:
                 (void) hashDictionary.remove(op.key);
                 break;
+            case OpCode::Lookup:
+                (void) hashDictionary.member(op.key);
+                break;
         }
     }
     std::cout << "in run trace printing csv.\n";
@@ -144,7 +129,15 @@ int main(int argc, char *argv[]) {
     std::cout << "in run trace printing csv ends.\n";
 
 
-    hashDictionary.printMask();
+    // printMask() writes one colored character per slot, which is unusable past
+    // the table for N = 8192. The image covers any table size.
+    const std::size_t MAX_PRINTED_MASK_SIZE = N_to_M_mapping.at(8192);
+    if (tableSize <= MAX_PRINTED_MASK_SIZE)
+        hashDictionary.printMask();
+    if (hashDictionary.exportStructureMap("structure_map.ppm"))
+        std::cout << "Structure map written to structure_map.ppm" << std::endl;
+    if (hashDictionary.writeStructureTimeline("structure_timeline.bin"))
+        std::cout << "Structure timeline written to structure_timeline.bin" << std::endl;
     hashDictionary.printStats();
     if (doWePerformCompaction)
         hashDictionary.printBeforeAndAfterCompactionMaps();
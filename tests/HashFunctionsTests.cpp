@@ -0,0 +1,108 @@
+//
+// HashFunctionsTests.cpp - The batched polynomial hash must agree with the
+// scalar hashes it replaces, in particular for moduli at the edge of the
+// AVX2 path's 32-bit lanes, and a table driven by batch hashes must end up
+// where the scalar calls leave it.
+//
+
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../HashFunctions.hpp"
+#include "../HashTableDictionary.hpp"
+#include "TestCheck.hpp"
+
+namespace {
+// Keys of every length from 0 to 40 over the full byte range, plus the long
+// two-word keys the traces use, so every lane finishes at a different point.
+std::vector<std::string> testKeys() {
+    std::mt19937_64 rng(42);
+    std::vector<std::string> keys;
+    for (std::size_t length = 0; length <= 40; length++) {
+        for (int copy = 0; copy < 3; copy++) {
+            std::string key(length, '\0');
+            for (auto& c : key)
+                c = static_cast<char>(rng() & 0xff);
+            keys.push_back(key);
+        }
+    }
+    for (const char* key : {"alpha beta", "zzzzzzzzzzzz zzzzzzzzzzzz", "\xff\xff\xff\xff\xff\xff\xff"})
+        keys.emplace_back(key);
+    return keys;
+}
+
+void checkBatchMatchesScalar(const std::vector<std::string_view>& keys, std::size_t modulus) {
+    const std::size_t stepModulus = modulus - 1;
+    std::vector<std::size_t> home(keys.size()), step(keys.size());
+    std::vector<std::uint32_t> fingerprint(keys.size());
+    polynomialModHashBatch(keys.data(), keys.size(), modulus, stepModulus, home.data(), step.data(), fingerprint.data());
+
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        mismatches += home[i] != polynomialModHash(keys[i], 131, modulus);
+        mismatches += step[i] != polynomialModHash(keys[i], 257, stepModulus);
+        mismatches += fingerprint[i] != static_cast<std::uint32_t>(polynomialHash64(keys[i], 131));
+    }
+    check(mismatches == 0, "polynomialModHashBatch differs from the scalar hashes for M = " + std::to_string(modulus)
+                           + " (" + std::to_string(mismatches) + " mismatches)");
+}
+}
+
+int main() {
+    const auto keys = testKeys();
+    const std::vector<std::string_view> views(keys.begin(), keys.end());
+
+    // Small and Section 4.4 sizes, the largest modulus the AVX2 path takes
+    // ((2^31 - 256) / 257 = 8355967) and its neighbours, and primes just
+    // below 2^23, which overflowed the lanes under the old 2^23 bound.
+    for (std::size_t modulus : {3, 1279, 10273, 20479, 8355966, 8355967, 8355968, 8355969,
+                                8388593, 8388607, 8388617, 100000007})
+        checkBatchMatchesScalar(views, modulus);
+
+    // Fewer keys than one AVX2 pass, and a count that leaves a scalar tail.
+    checkBatchMatchesScalar(std::vector<std::string_view>(views.begin(), views.begin() + 5), 8355967);
+    checkBatchMatchesScalar(std::vector<std::string_view>(views.begin(), views.begin() + 13), 1279);
+
+    // The table's batch hash probes where insert() would, across several of
+    // its internal chunks.
+    for (auto probe : {HashTableDictionary::SINGLE, HashTableDictionary::DOUBLE}) {
+        const std::size_t M = 1279;
+        HashTableDictionary table(M, probe);
+        std::vector<HashTableDictionary::HashedKey> hashed(views.size());
+        table.hashBatch(views.data(), views.size(), hashed.data());
+        std::size_t mismatches = 0;
+        for (std::size_t i = 0; i < views.size(); i++) {
+            const std::size_t step = probe == HashTableDictionary::SINGLE ? 1 : 1 + polynomialModHash(views[i], 257, M - 1);
+            mismatches += hashed[i].home != polynomialModHash(views[i], 131, M) || hashed[i].step != step;
+        }
+        check(mismatches == 0, "hashBatch differs from the scalar probe sequence");
+    }
+
+    // Replaying through the HashedKey overloads leaves a table in the state
+    // the plain insert/remove/member calls do, compaction included.
+    for (auto policy : {HashTableDictionary::POLYNOMIAL, HashTableDictionary::SIPHASH}) {
+        HashTableDictionary scalar(257, HashTableDictionary::DOUBLE, true, 0.4, policy);
+        HashTableDictionary batched(257, HashTableDictionary::DOUBLE, true, 0.4, policy);
+        scalar.reseedHash(1, 2);
+        batched.reseedHash(1, 2);
+        std::vector<HashTableDictionary::HashedKey> hashed(views.size());
+        batched.hashBatch(views.data(), views.size(), hashed.data());
+        for (std::size_t i = 0; i < views.size(); i++) {
+            scalar.insert(views[i]);
+            batched.insert(views[i], hashed[i]);
+            if (i % 3 == 0) {
+                scalar.remove(views[i / 2]);
+                batched.remove(views[i / 2], hashed[i / 2]);
+            }
+            check(scalar.member(views[i / 3]) == batched.member(views[i / 3], hashed[i / 3]),
+                  "HashedKey member() differs from member()");
+        }
+        check(scalar.csvStats() == batched.csvStats(), "HashedKey replay leaves a different table");
+    }
+
+    return testResult("hash function tests passed");
+}
@@ -0,0 +1,66 @@
+//
+// TableSizesTests.cpp - Primality, next-prime and table sizing against known
+// values, and the Section 4.4 sizes of the standard trace capacities.
+//
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../TableSizes.hpp"
+#include "TestCheck.hpp"
+
+namespace {
+bool isPrimeByTrialDivision(std::uint64_t n) {
+    if (n < 2)
+        return false;
+    for (std::uint64_t d = 2; d * d <= n; d++) {
+        if (n % d == 0)
+            return false;
+    }
+    return true;
+}
+}
+
+int main() {
+    for (std::uint64_t n = 0; n < 100000; n++) {
+        if (isPrime(n) != isPrimeByTrialDivision(n))
+            check(false, "isPrime(" + std::to_string(n) + ") disagrees with trial division");
+    }
+
+    for (std::uint64_t p : {4294967291ULL, 4294967311ULL, 1000000007ULL, 2305843009213693951ULL,
+                            18446744073709551557ULL})
+        check(isPrime(p), "isPrime(" + std::to_string(p) + ") should be true");
+
+    // Carmichael numbers fool the Fermat test for every coprime base;
+    // 3825123056546413051 is a strong pseudoprime to bases 2 through 23.
+    for (std::uint64_t c : {561ULL, 1105ULL, 1729ULL, 2465ULL, 2821ULL, 6601ULL, 8911ULL, 41041ULL, 825265ULL,
+                            321197185ULL, 5394826801ULL, 232250619601ULL, 9746347772161ULL,
+                            3825123056546413051ULL, 4294967291ULL * 4294967279ULL})
+        check(!isPrime(c), "isPrime(" + std::to_string(c) + ") should be false");
+
+    const std::vector<std::pair<std::uint64_t, std::uint64_t>> nextPrimes = {
+        {0, 2}, {1, 2}, {2, 2}, {3, 3}, {4, 5}, {1280, 1283}, {2000, 2003},
+        {4294967296ULL, 4294967311ULL}, {18446744073709551557ULL, 18446744073709551557ULL}};
+    for (const auto& [n, p] : nextPrimes)
+        check(nextPrime(n) == p, "nextPrime(" + std::to_string(n) + ") should be " + std::to_string(p));
+
+    check(tableSizeForLoad(1000, 0.5) == 2003, "tableSizeForLoad(1000, 0.5)");
+    check(tableSizeForLoad(1000, 1.0) == 1009, "tableSizeForLoad(1000, 1.0)");
+    check(tableSizeForLoad(1000, 0.5, TableRounding::POWER_OF_TWO) == 2048, "tableSizeForLoad(1000, 0.5, pow2)");
+    check(tableSizeForLoad(3000, 0.95) == 3163, "tableSizeForLoad(3000, 0.95)");
+    check(tableSizeForN(3000) == 3761, "tableSizeForN(3000) should use the default load factor");
+
+    // The Section 4.4 sizes, spelled out so a change to N_to_M_mapping is caught.
+    const std::vector<std::pair<std::size_t, std::size_t>> section44 = {
+        {1024, 1279}, {2048, 2551}, {4096, 5101}, {8192, 10273}, {16384, 20479}, {32768, 40849},
+        {65536, 81931}, {131072, 163861}, {262144, 327739}, {524288, 655243}, {1048576, 1310809}};
+    check(N_to_M_mapping.size() == section44.size(), "N_to_M_mapping has " + std::to_string(section44.size()) + " sizes");
+    for (const auto& [N, M] : section44) {
+        check(tableSizeForN(N) == M, "tableSizeForN(" + std::to_string(N) + ") should be " + std::to_string(M));
+        check(isPrime(M), "Section 4.4 size " + std::to_string(M) + " should be prime");
+    }
+
+    return testResult("table size tests passed");
+}
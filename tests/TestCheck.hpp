@@ -0,0 +1,29 @@
+//
+// TestCheck.hpp - The check() and exit code shared by the test executables.
+//
+
+#ifndef HASHTABLESOPENADDRESSING_TESTCHECK_HPP
+#define HASHTABLESOPENADDRESSING_TESTCHECK_HPP
+
+#include <iostream>
+#include <string>
+
+inline int failures = 0;
+
+// Records a failure and carries on, so one run reports every broken case.
+inline void check(bool ok, const std::string& what) {
+    if (!ok) {
+        std::cerr << "FAIL: " << what << std::endl;
+        failures++;
+    }
+}
+
+// main's exit code: 1 after any failed check, otherwise 0 with `passed`.
+inline int testResult(const std::string& passed) {
+    if (failures != 0)
+        return 1;
+    std::cout << passed << std::endl;
+    return 0;
+}
+
+#endif //HASHTABLESOPENADDRESSING_TESTCHECK_HPP